@@ -0,0 +1,128 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the memory arena.
+ *
+ * Parsing a document creates many small objects: the nodes, their text
+ * and their attributes. Allocating each one of them on the heap is slow
+ * and scatters the tree in memory. The arena instead hands out the memory
+ * from blocks which grow geometrically, so a large document only needs a
+ * few blocks and its nodes end up next to each other in document order.
+ *
+ * Memory given back to the arena is not reused. It only gets released
+ * when the arena gets destroyed, which happens once the last node
+ * allocated from it is gone. So modifying the text or attributes of a
+ * node many times after the document was loaded makes the arena grow.
+ */
+
+// self
+//
+#include    "basic-xml/arena.h"
+
+
+// snapdev
+//
+#include    <snapdev/not_used.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+/** \brief Initialize an empty arena.
+ *
+ * The first block gets allocated on the first allocation.
+ */
+arena::arena()
+{
+}
+
+
+/** \brief Get the number of bytes allocated from this arena.
+ *
+ * This is the total of all the allocations, including the memory which
+ * was given back. It does not include the unused space at the end of
+ * the blocks.
+ *
+ * \return The number of bytes allocated so far.
+ */
+std::size_t arena::allocated() const
+{
+    std::lock_guard lock(f_mutex);
+    return f_allocated;
+}
+
+
+/** \brief Allocate memory from the current block.
+ *
+ * A node can still be modified after the document was loaded, possibly
+ * from another thread, so the allocations are protected by a mutex.
+ *
+ * \param[in] bytes  The number of bytes to allocate.
+ * \param[in] alignment  The alignment of the allocated memory.
+ *
+ * \return A pointer to the allocated memory.
+ */
+void * arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    std::lock_guard lock(f_mutex);
+    f_allocated += bytes;
+    return f_blocks.allocate(bytes, alignment);
+}
+
+
+/** \brief Give memory back to the arena.
+ *
+ * The memory of an arena is only released once the arena gets destroyed
+ * so this function does nothing.
+ *
+ * \param[in] p  The memory to give back.
+ * \param[in] bytes  The size of that memory.
+ * \param[in] alignment  The alignment of that memory.
+ */
+void arena::do_deallocate(void * p, std::size_t bytes, std::size_t alignment)
+{
+    snapdev::NOT_USED(p, bytes, alignment);
+}
+
+
+/** \brief Check whether two memory resources are the same.
+ *
+ * Memory allocated by an arena can only be given back to that arena.
+ *
+ * \param[in] other  The other memory resource.
+ *
+ * \return true if \p other is this arena.
+ */
+bool arena::do_is_equal(std::pmr::memory_resource const & other) const noexcept
+{
+    return this == &other;
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,126 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Memory arena used to allocate the nodes of a document.
+ *
+ * The arena allocates the nodes, their text and their attributes from
+ * large blocks of memory, in document order. The blocks are all released
+ * at once when the last node of the document gets destroyed.
+ */
+
+// C++
+//
+#include    <cstddef>
+#include    <memory>
+#include    <memory_resource>
+#include    <mutex>
+
+
+
+namespace basic_xml
+{
+
+
+
+class arena
+    : public std::pmr::memory_resource
+{
+public:
+    typedef std::shared_ptr<arena>  pointer_t;
+
+                                    arena();
+                                    arena(arena const &) = delete;
+
+    arena &                         operator = (arena const &) = delete;
+
+    std::size_t                     allocated() const;
+
+private:
+    virtual void *                  do_allocate(std::size_t bytes, std::size_t alignment) override;
+    virtual void                    do_deallocate(void * p, std::size_t bytes, std::size_t alignment) override;
+    virtual bool                    do_is_equal(std::pmr::memory_resource const & other) const noexcept override;
+
+    mutable std::mutex              f_mutex = std::mutex();
+    std::pmr::monotonic_buffer_resource
+                                    f_blocks = std::pmr::monotonic_buffer_resource();
+    std::size_t                     f_allocated = 0;
+};
+
+
+/** \brief Allocator keeping its arena alive.
+ *
+ * The shared pointers created with std::allocate_shared() save a copy
+ * of this allocator in their control block. That way the arena remains
+ * valid until the last node allocated from it gets destroyed, even if
+ * the document itself was released first.
+ */
+template<typename T>
+class arena_allocator
+{
+public:
+    typedef T                       value_type;
+
+    arena_allocator(arena::pointer_t a) noexcept
+        : f_arena(std::move(a))
+    {
+    }
+
+    template<typename U>
+    arena_allocator(arena_allocator<U> const & rhs) noexcept
+        : f_arena(rhs.get_arena())
+    {
+    }
+
+    T * allocate(std::size_t n)
+    {
+        return static_cast<T *>(f_arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T * p, std::size_t n) noexcept
+    {
+        f_arena->deallocate(p, n * sizeof(T), alignof(T));
+    }
+
+    arena::pointer_t const & get_arena() const noexcept
+    {
+        return f_arena;
+    }
+
+    template<typename U>
+    bool operator == (arena_allocator<U> const & rhs) const noexcept
+    {
+        return f_arena == rhs.get_arena();
+    }
+
+    template<typename U>
+    bool operator != (arena_allocator<U> const & rhs) const noexcept
+    {
+        return f_arena != rhs.get_arena();
+    }
+
+private:
+    arena::pointer_t                f_arena = arena::pointer_t();
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
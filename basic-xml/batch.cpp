@@ -0,0 +1,279 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the batch loader.
+ *
+ * Services often load many small XML files on startup. Loading them one
+ * after the other leaves all but one CPU idle. The batch object instead
+ * gives the files to a pool of threads, each thread loading the next
+ * file not yet loaded until all the files were handled.
+ *
+ * \code
+ *     basic_xml::batch b;
+ *     b.add_directory("/usr/share/my-service/tables");
+ *     b.load();
+ *     for(auto const & e : b.errors())
+ *     {
+ *         std::cerr << e.second << "\n";
+ *     }
+ *     for(auto const & d : b.documents())
+ *     {
+ *         ...d.second->root()...
+ *     }
+ * \endcode
+ */
+
+// self
+//
+#include    "basic-xml/batch.h"
+
+#include    "basic-xml/exception.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <atomic>
+#include    <filesystem>
+#include    <thread>
+#include    <vector>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Join the worker threads.
+ *
+ * The threads must be joined before they get destroyed, even when
+ * starting one of them fails, or std::terminate() gets called.
+ */
+class join_threads
+{
+public:
+    join_threads(std::vector<std::thread> & threads)
+        : f_threads(threads)
+    {
+    }
+
+    join_threads(join_threads const &) = delete;
+    join_threads & operator = (join_threads const &) = delete;
+
+    ~join_threads()
+    {
+        for(auto & t : f_threads)
+        {
+            t.join();
+        }
+    }
+
+private:
+    std::vector<std::thread> &  f_threads;
+};
+
+
+
+} // no name namespace
+
+
+
+/** \brief Initialize a batch loader.
+ *
+ * The \p thread_count parameter defines the maximum number of threads
+ * used to load the files. The load() function never creates more threads
+ * than there are files to load.
+ *
+ * \param[in] thread_count  The maximum number of threads; 0 means one
+ * per CPU.
+ */
+batch::batch(std::size_t thread_count)
+    : f_thread_count(thread_count)
+{
+    if(f_thread_count == 0)
+    {
+        f_thread_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+}
+
+
+/** \brief Add one file to the batch.
+ *
+ * The file is not opened until load() gets called. Adding the same
+ * file more than once has no effect.
+ *
+ * \param[in] filename  The name of the XML file to load.
+ */
+void batch::add_file(std::string const & filename)
+{
+    if(std::find(f_filenames.begin(), f_filenames.end(), filename) == f_filenames.end())
+    {
+        f_filenames.push_back(filename);
+    }
+}
+
+
+/** \brief Add the files of a directory to the batch.
+ *
+ * This function adds all the regular files found in \p path which name
+ * ends with \p extension. Sub-directories are not searched.
+ *
+ * \exception file_not_found
+ * The directory could not be read.
+ *
+ * \param[in] path  The directory to search.
+ * \param[in] extension  The extension of the files to load.
+ */
+void batch::add_directory(std::string const & path, std::string const & extension)
+{
+    std::error_code ec;
+    std::filesystem::directory_iterator it(path, ec);
+    if(ec)
+    {
+        throw file_not_found("could not read XML directory \""
+                           + path
+                           + "\": " + ec.message() + ".");
+    }
+
+    std::vector<std::string> filenames;
+    for(auto const & entry : it)
+    {
+        std::string const filename(entry.path().string());
+        if(entry.is_regular_file(ec)
+        && filename.length() > extension.length()
+        && filename.compare(filename.length() - extension.length(), extension.length(), extension) == 0)
+        {
+            filenames.push_back(filename);
+        }
+    }
+
+    // the directory order is not defined
+    //
+    std::sort(filenames.begin(), filenames.end());
+    for(auto const & f : filenames)
+    {
+        add_file(f);
+    }
+}
+
+
+/** \brief Load all the files.
+ *
+ * This function loads all the files added with add_file() and
+ * add_directory(). Each thread of the pool loads the next file which
+ * was not yet loaded.
+ *
+ * The function does not throw on a parse error. The files which loaded
+ * are available with documents() and the error messages of the files
+ * which failed to load with errors(). Both maps use the filename as
+ * the key.
+ *
+ * Calling load() again reloads all the files.
+ */
+void batch::load()
+{
+    f_documents.clear();
+    f_errors.clear();
+
+    std::vector<xml::pointer_t> documents(f_filenames.size());
+    std::vector<std::string> errors(f_filenames.size());
+    std::atomic<std::size_t> next(0);
+
+    auto worker = [&]()
+    {
+        for(;;)
+        {
+            std::size_t const idx(next++);
+            if(idx >= f_filenames.size())
+            {
+                return;
+            }
+            try
+            {
+                documents[idx] = std::make_shared<xml>(f_filenames[idx]);
+            }
+            catch(std::exception const & e)
+            {
+                errors[idx] = e.what();
+            }
+        }
+    };
+
+    std::size_t const count(std::min(f_thread_count, f_filenames.size()));
+    if(count > 0)
+    {
+        std::vector<std::thread> threads;
+        join_threads const join(threads);
+        threads.reserve(count - 1);
+        for(std::size_t idx(1); idx < count; ++idx)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+    }
+
+    for(std::size_t idx(0); idx < f_filenames.size(); ++idx)
+    {
+        if(documents[idx] != nullptr)
+        {
+            f_documents[f_filenames[idx]] = documents[idx];
+        }
+        else
+        {
+            f_errors[f_filenames[idx]] = errors[idx];
+        }
+    }
+}
+
+
+/** \brief Get the documents which were loaded.
+ *
+ * \return A map of the XML documents indexed by filename.
+ */
+xml::map_t const & batch::documents() const
+{
+    return f_documents;
+}
+
+
+/** \brief Get the errors found while loading the files.
+ *
+ * \return A map of the error messages indexed by filename.
+ */
+batch::error_map_t const & batch::errors() const
+{
+    return f_errors;
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
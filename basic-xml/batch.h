@@ -0,0 +1,70 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Load many XML files at once.
+ *
+ * The batch object parses a list of XML files using a pool of threads.
+ */
+
+// self
+//
+#include    <basic-xml/xml.h>
+
+
+// C++
+//
+#include    <vector>
+
+
+
+namespace basic_xml
+{
+
+
+
+class batch
+{
+public:
+    typedef std::map<std::string, std::string>
+                                    error_map_t;
+
+                                    batch(std::size_t thread_count = 0);
+
+    void                            add_file(std::string const & filename);
+    void                            add_directory(
+                                              std::string const & path
+                                            , std::string const & extension = ".xml");
+    void                            load();
+
+    xml::map_t const &              documents() const;
+    error_map_t const &             errors() const;
+
+private:
+    std::size_t                     f_thread_count = 0;
+    std::vector<std::string>        f_filenames = std::vector<std::string>();
+    xml::map_t                      f_documents = xml::map_t();
+    error_map_t                     f_errors = error_map_t();
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,245 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the child reader.
+ *
+ * The child reader is used to go through the children of the root tag
+ * without loading the whole file in memory:
+ *
+ * \code
+ *     basic_xml::child_reader r(filename);
+ *     for(basic_xml::node::pointer_t record(r.next());
+ *         record != nullptr;
+ *         record = r.next())
+ *     {
+ *         std::cout << record->attribute("id") << "\n";
+ *     }
+ * \endcode
+ *
+ * The children returned by next() are not added to the root node. Once
+ * your code releases a child, its memory is freed.
+ */
+
+// self
+//
+#include    "basic-xml/child_reader.h"
+
+#include    "basic-xml/mapped_file.h"
+#include    "basic-xml/parser.h"
+#include    "basic-xml/tree_builder.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+/** \brief Read the children of the root of an XML file.
+ *
+ * The file gets memory mapped. When the file cannot be mapped (i.e. a
+ * pipe), it gets read in memory first.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \param[in] filename  The name of the file to read.
+ */
+child_reader::child_reader(std::string const & filename)
+    : f_builder(std::make_unique<tree_builder>(f_child))
+    , f_file(std::make_unique<mapped_file>(filename))
+    , f_parser(std::make_unique<parser>(
+                  filename
+                , f_file->data()
+                , f_file->size()
+                , static_cast<handler &>(*this)))
+{
+}
+
+
+/** \brief Read the children of the root of an XML stream.
+ *
+ * The stream is read in blocks as the children get read.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ */
+child_reader::child_reader(std::string const & filename, std::istream & in)
+    : f_builder(std::make_unique<tree_builder>(f_child))
+    , f_parser(std::make_unique<parser>(filename, in, static_cast<handler &>(*this)))
+{
+}
+
+
+/** \brief Read the children of the root of an XML buffer.
+ *
+ * The buffer must remain valid as long as the child reader is in use.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] data  A pointer to the XML data.
+ * \param[in] size  The number of bytes in \p data.
+ */
+child_reader::child_reader(std::string const & filename, char const * data, std::size_t size)
+    : f_builder(std::make_unique<tree_builder>(f_child))
+    , f_parser(std::make_unique<parser>(filename, data, size, static_cast<handler &>(*this)))
+{
+}
+
+
+/** \brief Clean up the child reader.
+ *
+ * The destructor is defined here because the parser is not defined
+ * in the public header.
+ */
+child_reader::~child_reader()
+{
+}
+
+
+/** \brief Get the root node.
+ *
+ * The root node includes its attributes and the text found directly in
+ * it so far, except for the spaces between children. Its children are
+ * only returned by next(); they never get added to the root node.
+ *
+ * \return The root node.
+ */
+node::pointer_t child_reader::root()
+{
+    while(f_root == nullptr
+       && f_parser->step())
+    {
+    }
+    return f_root;
+}
+
+
+/** \brief Read the next child of the root.
+ *
+ * This function parses the input until the next child of the root tag
+ * was completely read and returns it with all its descendants.
+ *
+ * \return The next child or nullptr once the end of the root was reached.
+ */
+node::pointer_t child_reader::next()
+{
+    f_ready = false;
+    while(!f_ready)
+    {
+        if(!f_parser->step())
+        {
+            return node::pointer_t();
+        }
+    }
+
+    node::pointer_t result;
+    result.swap(f_child);
+    return result;
+}
+
+
+/** \brief Handle a start tag.
+ *
+ * The first tag is the root. The other tags are sent to the tree builder.
+ *
+ * \param[in] name  The name of the tag.
+ */
+void child_reader::start_tag(std::string_view name)
+{
+    if(f_depth == 0)
+    {
+        f_root = std::make_shared<node>(std::string(name));
+    }
+    else
+    {
+        f_builder->start_tag(name);
+    }
+    ++f_depth;
+}
+
+
+/** \brief Handle an attribute.
+ *
+ * \param[in] name  The name of the attribute.
+ * \param[in] value  The value of the attribute.
+ */
+void child_reader::attribute(std::string_view name, std::string_view value)
+{
+    if(f_depth == 1)
+    {
+        f_root->set_attribute(std::string(name), std::string(value));
+    }
+    else
+    {
+        f_builder->attribute(name, value);
+    }
+}
+
+
+/** \brief Handle text.
+ *
+ * The spaces found between the children of the root tag are not added
+ * to the root node. Otherwise the text of the root would grow with each
+ * child read.
+ *
+ * \param[in] value  The text.
+ */
+void child_reader::text(std::string_view value)
+{
+    if(f_depth == 1)
+    {
+        if(value.find_first_not_of(" \t\n\r\v\f") != std::string::npos)
+        {
+            f_root->append_text(std::string(value));
+        }
+    }
+    else
+    {
+        f_builder->text(value);
+    }
+}
+
+
+/** \brief Handle an end tag.
+ *
+ * When the end tag of a child of the root is found, that child is ready
+ * to be returned by next().
+ *
+ * \param[in] name  The name of the tag.
+ */
+void child_reader::end_tag(std::string_view name)
+{
+    --f_depth;
+    if(f_depth > 0)
+    {
+        f_builder->end_tag(name);
+        f_ready = f_depth == 1;
+    }
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
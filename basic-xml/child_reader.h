@@ -0,0 +1,80 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Read the children of the root tag one at a time.
+ *
+ * Large XML files are often a long list of records under the root tag.
+ * The child_reader returns each one of those records as a tree of nodes
+ * and forgets about it before reading the next one. The memory used is
+ * therefore limited to one record.
+ */
+
+// self
+//
+#include    <basic-xml/handler.h>
+#include    <basic-xml/node.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+class mapped_file;
+class parser;
+class tree_builder;
+
+
+class child_reader
+    : private handler
+{
+public:
+                                    child_reader(std::string const & filename);
+                                    child_reader(std::string const & filename, std::istream & in);
+                                    child_reader(std::string const & filename, char const * data, std::size_t size);
+                                    child_reader(child_reader const &) = delete;
+    virtual                         ~child_reader();
+
+    child_reader &                  operator = (child_reader const &) = delete;
+
+    node::pointer_t                 root();
+    node::pointer_t                 next();
+
+private:
+    virtual void                    start_tag(std::string_view name) override;
+    virtual void                    attribute(std::string_view name, std::string_view value) override;
+    virtual void                    text(std::string_view value) override;
+    virtual void                    end_tag(std::string_view name) override;
+
+    node::pointer_t                 f_root = node::pointer_t();
+    node::pointer_t                 f_child = node::pointer_t();
+    std::size_t                     f_depth = 0;
+    bool                            f_ready = false;
+    std::unique_ptr<tree_builder>   f_builder{};
+    std::unique_ptr<mapped_file>    f_file{};
+    std::unique_ptr<parser>         f_parser{};
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
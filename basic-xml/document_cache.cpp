@@ -0,0 +1,293 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the document cache.
+ *
+ * The cache identifies a file by the information returned by stat(2):
+ * the device, the inode, the size and the modification time. If any one
+ * of these changes, the file is parsed again. This catches files which
+ * get edited in place as well as files replaced by a rename(2).
+ *
+ * The least recently used document gets removed once the cache is full.
+ * The trees remain valid for the components still holding them since
+ * they are shared pointers.
+ */
+
+// self
+//
+#include    "basic-xml/document_cache.h"
+
+#include    "basic-xml/exception.h"
+#include    "basic-xml/xml.h"
+
+
+// C
+//
+#include    <string.h>
+#include    <sys/stat.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+/** \brief Compare two file identities.
+ *
+ * \param[in] rhs  The other identity.
+ *
+ * \return true if both identities represent the same version of a file.
+ */
+bool document_cache::identity_t::operator == (identity_t const & rhs) const
+{
+    return f_device == rhs.f_device
+        && f_inode == rhs.f_inode
+        && f_size == rhs.f_size
+        && f_mtime_sec == rhs.f_mtime_sec
+        && f_mtime_nsec == rhs.f_mtime_nsec;
+}
+
+
+/** \brief Initialize the cache.
+ *
+ * The trees are shared between all the callers of load() and possibly
+ * between threads. For that reason, the entities always get decoded
+ * while parsing (the lazy mode would modify the nodes on their first
+ * access). The other options apply as is.
+ *
+ * \param[in] max_documents  The maximum number of documents kept in the
+ * cache; 0 means no limit.
+ * \param[in] options  The options used to parse the files.
+ */
+document_cache::document_cache(std::size_t max_documents, parse_options const & options)
+    : f_options(options)
+    , f_max_documents(max_documents)
+{
+    f_options.f_decode = decode_t::DECODE_NOW;
+}
+
+
+/** \brief Get the tree of an XML file.
+ *
+ * If the file was already loaded and did not change since, the same
+ * tree is returned. Otherwise the file gets parsed and the new tree
+ * replaces the old one in the cache.
+ *
+ * The returned tree is shared with the other callers. It must not be
+ * modified.
+ *
+ * The file is parsed without holding the lock so other threads can
+ * still use the cache in the meantime. If two threads load the same
+ * file at the same time, it may get parsed twice.
+ *
+ * \exception file_not_found
+ * The file does not exist or cannot be opened.
+ *
+ * \exception xml_error
+ * The file could not be parsed. In this case the file is also removed
+ * from the cache.
+ *
+ * \param[in] filename  The name of the XML file to load.
+ *
+ * \return The root node of the file.
+ */
+node::pointer_t document_cache::load(std::string const & filename)
+{
+    // the stat() happens before the parsing so a change made while we
+    // parse is detected on the next call
+    //
+    struct stat s;
+    if(stat(filename.c_str(), &s) != 0)
+    {
+        int const e(errno);
+        erase(filename);
+        throw file_not_found("could not open XML file \""
+                           + filename
+                           + "\": " + strerror(e) + ".");
+    }
+    identity_t identity;
+    identity.f_device = s.st_dev;
+    identity.f_inode = s.st_ino;
+    identity.f_size = s.st_size;
+    identity.f_mtime_sec = s.st_mtim.tv_sec;
+    identity.f_mtime_nsec = s.st_mtim.tv_nsec;
+
+    {
+        std::lock_guard<std::mutex> lock(f_mutex);
+        auto const it(f_entries.find(filename));
+        if(it != f_entries.end()
+        && it->second->f_identity == identity)
+        {
+            ++f_hits;
+            f_lru.splice(f_lru.begin(), f_lru, it->second);
+            return it->second->f_root;
+        }
+        ++f_misses;
+    }
+
+    node::pointer_t root;
+    try
+    {
+        xml x(filename, f_options);
+        root = x.root();
+    }
+    catch(xml_error const &)
+    {
+        erase(filename);
+        throw;
+    }
+
+    std::lock_guard<std::mutex> lock(f_mutex);
+    auto const it(f_entries.find(filename));
+    if(it != f_entries.end())
+    {
+        it->second->f_identity = identity;
+        it->second->f_root = root;
+        f_lru.splice(f_lru.begin(), f_lru, it->second);
+    }
+    else
+    {
+        f_lru.push_front(entry_t{ filename, identity, root });
+        f_entries[filename] = f_lru.begin();
+        evict();
+    }
+
+    return root;
+}
+
+
+/** \brief Remove a file from the cache.
+ *
+ * The trees already returned by load() remain valid.
+ *
+ * \param[in] filename  The name of the file to remove.
+ */
+void document_cache::erase(std::string const & filename)
+{
+    std::lock_guard<std::mutex> lock(f_mutex);
+    auto const it(f_entries.find(filename));
+    if(it != f_entries.end())
+    {
+        f_lru.erase(it->second);
+        f_entries.erase(it);
+    }
+}
+
+
+/** \brief Remove all the files from the cache.
+ *
+ * The hit and miss counters are not reset.
+ */
+void document_cache::clear()
+{
+    std::lock_guard<std::mutex> lock(f_mutex);
+    f_lru.clear();
+    f_entries.clear();
+}
+
+
+/** \brief Get the number of documents in the cache.
+ *
+ * \return The number of documents currently cached.
+ */
+std::size_t document_cache::size() const
+{
+    std::lock_guard<std::mutex> lock(f_mutex);
+    return f_lru.size();
+}
+
+
+/** \brief Get the maximum number of documents.
+ *
+ * \return The maximum number of documents, 0 if there is no limit.
+ */
+std::size_t document_cache::max_documents() const
+{
+    std::lock_guard<std::mutex> lock(f_mutex);
+    return f_max_documents;
+}
+
+
+/** \brief Change the maximum number of documents.
+ *
+ * If the cache holds more documents than the new limit, the least
+ * recently used ones are removed immediately.
+ *
+ * \param[in] max_documents  The new maximum; 0 means no limit.
+ */
+void document_cache::set_max_documents(std::size_t max_documents)
+{
+    std::lock_guard<std::mutex> lock(f_mutex);
+    f_max_documents = max_documents;
+    evict();
+}
+
+
+/** \brief Get the number of calls to load() which used the cache.
+ *
+ * \return The number of cache hits.
+ */
+std::uint64_t document_cache::hits() const
+{
+    std::lock_guard<std::mutex> lock(f_mutex);
+    return f_hits;
+}
+
+
+/** \brief Get the number of calls to load() which parsed the file.
+ *
+ * This includes the calls which failed because the file was invalid.
+ *
+ * \return The number of cache misses.
+ */
+std::uint64_t document_cache::misses() const
+{
+    std::lock_guard<std::mutex> lock(f_mutex);
+    return f_misses;
+}
+
+
+/** \brief Remove the least recently used documents.
+ *
+ * This function must be called with the mutex locked.
+ */
+void document_cache::evict()
+{
+    if(f_max_documents == 0)
+    {
+        return;
+    }
+
+    while(f_lru.size() > f_max_documents)
+    {
+        f_entries.erase(f_lru.back().f_filename);
+        f_lru.pop_back();
+    }
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,109 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Share the trees of XML files loaded by several components.
+ *
+ * The document_cache object keeps the trees of the files it loaded so
+ * the next request for the same file does not parse it again. A file
+ * gets parsed again only once it changes on disk.
+ */
+
+// self
+//
+#include    <basic-xml/node.h>
+#include    <basic-xml/parse_options.h>
+
+
+// C++
+//
+#include    <cstdint>
+#include    <list>
+#include    <mutex>
+#include    <string>
+#include    <unordered_map>
+
+
+// C
+//
+#include    <sys/types.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+class document_cache
+{
+public:
+                                    document_cache(std::size_t max_documents = 0, parse_options const & options = parse_options());
+                                    document_cache(document_cache const &) = delete;
+
+    document_cache &                operator = (document_cache const &) = delete;
+
+    node::pointer_t                 load(std::string const & filename);
+    void                            erase(std::string const & filename);
+    void                            clear();
+
+    std::size_t                     size() const;
+    std::size_t                     max_documents() const;
+    void                            set_max_documents(std::size_t max_documents);
+    std::uint64_t                   hits() const;
+    std::uint64_t                   misses() const;
+
+private:
+    struct identity_t
+    {
+        bool                        operator == (identity_t const & rhs) const;
+
+        dev_t                       f_device = 0;
+        ino_t                       f_inode = 0;
+        off_t                       f_size = 0;
+        std::int64_t                f_mtime_sec = 0;
+        std::int64_t                f_mtime_nsec = 0;
+    };
+
+    struct entry_t
+    {
+        std::string                 f_filename = std::string();
+        identity_t                  f_identity = identity_t();
+        node::pointer_t             f_root = node::pointer_t();
+    };
+
+    typedef std::list<entry_t>      lru_t;
+
+    void                            evict();
+
+    mutable std::mutex              f_mutex = std::mutex();
+    parse_options                   f_options = parse_options();
+    std::size_t                     f_max_documents = 0;
+    lru_t                           f_lru = lru_t();
+    std::unordered_map<std::string, lru_t::iterator>
+                                    f_entries = std::unordered_map<std::string, lru_t::iterator>();
+    std::uint64_t                   f_hits = 0;
+    std::uint64_t                   f_misses = 0;
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,289 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the entity decoder.
+ *
+ * The parser and the nodes loaded in lazy mode both use this decoder
+ * to convert the entities found in text and attribute values.
+ */
+
+// self
+//
+#include    "basic-xml/entities.h"
+
+#include    "basic-xml/exception.h"
+
+
+// C++
+//
+#include    <cstring>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Decode one numeric entity.
+ *
+ * The \p name parameter points to the '#' of the entity and \p end to
+ * its ';'. The number is decimal unless it starts with an 'x' or 'X'
+ * in which case it is hexadecimal.
+ *
+ * The resulting character is written as UTF-8 at \p w. The caller
+ * makes sure that at least 4 bytes are available (the shortest
+ * entity, "&#N;", is 4 bytes and larger characters require longer
+ * entities, so the output never overtakes the input).
+ *
+ * \exception invalid_number
+ * The number is not valid or it does not represent a valid character.
+ *
+ * \param[in] name  The start of the entity name (the '#').
+ * \param[in] end  The end of the entity name (the ';').
+ * \param[in] w  Where the UTF-8 character gets saved.
+ * \param[in] location  A function returning the location used in error
+ * messages.
+ *
+ * \return The pointer right after the saved character.
+ */
+char * decode_numeric_entity(
+          char const * name
+        , char const * end
+        , char * w
+        , std::function<std::string()> const & location)
+{
+    bool const hex(name[1] == 'x' || name[1] == 'X');
+    char const * s(name + (hex ? 2 : 1));
+    bool valid(s < end);
+    char32_t unicode(0);
+    for(; s < end && valid; ++s)
+    {
+        char32_t digit;
+        if(*s >= '0' && *s <= '9')
+        {
+            digit = *s - '0';
+        }
+        else if(hex && *s >= 'a' && *s <= 'f')
+        {
+            digit = *s - ('a' - 10);
+        }
+        else if(hex && *s >= 'A' && *s <= 'F')
+        {
+            digit = *s - ('A' - 10);
+        }
+        else
+        {
+            valid = false;
+            break;
+        }
+        unicode = unicode * (hex ? 16 : 10) + digit;
+        valid = unicode <= 0x10FFFF;
+    }
+    if(!valid
+    || unicode == 0
+    || (unicode >= 0xD800 && unicode <= 0xDFFF))
+    {
+        throw invalid_number(
+              location()
+            + ": the number found in numeric entity, \""
+            + (hex ? '0' : ' ')
+            + std::string(name + 1, end - name - 1)
+            + "\", is not considered valid.");
+    }
+
+    if(unicode < 0x80)
+    {
+        *w++ = static_cast<char>(unicode);
+    }
+    else if(unicode < 0x800)
+    {
+        *w++ = static_cast<char>(0xC0 | (unicode >> 6));
+        *w++ = static_cast<char>(0x80 | (unicode & 0x3F));
+    }
+    else if(unicode < 0x10000)
+    {
+        *w++ = static_cast<char>(0xE0 | (unicode >> 12));
+        *w++ = static_cast<char>(0x80 | ((unicode >> 6) & 0x3F));
+        *w++ = static_cast<char>(0x80 | (unicode & 0x3F));
+    }
+    else
+    {
+        *w++ = static_cast<char>(0xF0 | (unicode >> 18));
+        *w++ = static_cast<char>(0x80 | ((unicode >> 12) & 0x3F));
+        *w++ = static_cast<char>(0x80 | ((unicode >> 6) & 0x3F));
+        *w++ = static_cast<char>(0x80 | (unicode & 0x3F));
+    }
+    return w;
+}
+
+
+
+} // no name namespace
+
+
+
+/** \brief Convert the entities found in a string.
+ *
+ * This function replaces the entities found in the \p size bytes at
+ * \p start with the corresponding characters. The conversion happens in place: the
+ * output of an entity is never longer than the entity itself, so a
+ * write cursor can follow the read cursor in the same buffer and no
+ * temporary string is allocated. Plain text between entities is moved
+ * in one go.
+ *
+ * An '&' without a following ';' is kept as is.
+ *
+ * \exception invalid_entity
+ * The entity name is empty, or it is a numeric entity without a number,
+ * or it is not one of the supported named entities.
+ *
+ * \exception invalid_number
+ * The numeric entity is not a valid number or it does not represent
+ * a valid Unicode character.
+ *
+ * \param[in,out] start  The string to convert.
+ * \param[in] size  The number of bytes in \p start.
+ * \param[in] location  A function returning the location used in error
+ * messages (i.e. the filename, line, and column). It only gets called
+ * when an error occurs.
+ *
+ * \return The new size of the string.
+ */
+std::size_t unescape_entities(char * start, std::size_t size, std::function<std::string()> const & location)
+{
+    char const * const end(start + size);
+    char const * r(static_cast<char const *>(memchr(start, '&', end - start)));
+    if(r == nullptr)
+    {
+        return size;
+    }
+    char * w(start + (r - start));
+    for(;;)
+    {
+        // r points to an '&'
+        //
+        char const * const name(r + 1);
+        char const * const semicolon(static_cast<char const *>(memchr(name, ';', end - name)));
+        if(semicolon == nullptr)
+        {
+            // generate an error here?
+            //
+            break;
+        }
+        std::size_t const length(semicolon - name);
+        char named('\0');
+        switch(length)
+        {
+        case 2:
+            if(name[1] == 't')
+            {
+                if(name[0] == 'l')
+                {
+                    named = '<';
+                }
+                else if(name[0] == 'g')
+                {
+                    named = '>';
+                }
+            }
+            break;
+
+        case 3:
+            if(memcmp(name, "amp", 3) == 0)
+            {
+                named = '&';
+            }
+            break;
+
+        case 4:
+            if(memcmp(name, "quot", 4) == 0)
+            {
+                named = '"';
+            }
+            else if(memcmp(name, "apos", 4) == 0)
+            {
+                named = '\'';
+            }
+            break;
+
+        }
+        if(named != '\0')
+        {
+            *w++ = named;
+        }
+        else if(length == 0)
+        {
+            throw invalid_entity(
+                      location()
+                    + ": the name of an entity cannot be empty (\"&;\" is not valid XML).");
+        }
+        else if(name[0] == '#')
+        {
+            if(length == 1)
+            {
+                throw invalid_entity(
+                      location()
+                    + ": a numeric entity must have a number (\"&#;\" is not valid XML).");
+            }
+            w = decode_numeric_entity(name, semicolon, w, location);
+        }
+        else
+        {
+            throw invalid_entity(
+                      location()
+                    + ": unsupported entity (\"&"
+                    + std::string(name, length)
+                    + ";\").");
+        }
+
+        r = semicolon + 1;
+        char const * const next(static_cast<char const *>(memchr(r, '&', end - r)));
+        char const * const stop(next == nullptr ? end : next);
+        memmove(w, r, stop - r);
+        w += stop - r;
+        if(next == nullptr)
+        {
+            return w - start;
+        }
+        r = next;
+    }
+
+    // keep the rest verbatim
+    //
+    memmove(w, r, end - r);
+    w += end - r;
+    return w - start;
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,44 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Decode XML entities.
+ *
+ * The decoder converts the entities supported by the parser to UTF-8.
+ */
+
+// C++
+//
+#include    <functional>
+#include    <string>
+
+
+
+namespace basic_xml
+{
+
+
+
+std::size_t             unescape_entities(char * start, std::size_t size, std::function<std::string()> const & location);
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
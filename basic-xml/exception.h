@@ -45,11 +45,17 @@ DECLARE_OUT_OF_RANGE(out_of_range);
 
 DECLARE_MAIN_EXCEPTION(xml_error);
 
+DECLARE_EXCEPTION(xml_error, compression_error);
 DECLARE_EXCEPTION(xml_error, file_not_found);
 DECLARE_EXCEPTION(xml_error, invalid_entity);
 DECLARE_EXCEPTION(xml_error, invalid_number);
+DECLARE_EXCEPTION(xml_error, invalid_snapshot);
 DECLARE_EXCEPTION(xml_error, invalid_token);
+DECLARE_EXCEPTION(xml_error, invalid_utf16);
+DECLARE_EXCEPTION(xml_error, invalid_utf8);
 DECLARE_EXCEPTION(xml_error, invalid_xml);
+DECLARE_EXCEPTION(xml_error, io_error);
+DECLARE_EXCEPTION(xml_error, limit_exceeded);
 DECLARE_EXCEPTION(xml_error, node_already_in_tree);
 DECLARE_EXCEPTION(xml_error, node_is_root);
 DECLARE_EXCEPTION(xml_error, unexpected_eof);
@@ -0,0 +1,450 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the compressed streams.
+ *
+ * Large XML exports are often kept compressed on disk. These streams
+ * let the parser read such files directly, decompressing one block at
+ * a time, instead of first decompressing them to a temporary file.
+ * The xml object and the other file based loaders detect gzip data and
+ * use the gzip_istream automatically.
+ *
+ * The gzip_ostream can be used to save a tree of nodes compressed:
+ *
+ * \code
+ *     std::ofstream out("export.xml.gz");
+ *     basic_xml::gzip_ostream z(out);
+ *     z << *root;
+ *     z.finish();
+ * \endcode
+ */
+
+// self
+//
+#include    "basic-xml/gzip.h"
+
+#include    "basic-xml/exception.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <climits>
+
+
+// zlib
+//
+#include    <zlib.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Size of the buffers used to compress and decompress data.
+ */
+constexpr std::size_t const     GZIP_BLOCK_SIZE = 64 * 1024;
+
+
+/** \brief The window bits parameter for a gzip stream.
+ *
+ * Adding 16 to the window size tells zlib to use a gzip header and
+ * trailer instead of a zlib header.
+ */
+constexpr int const             GZIP_WINDOW_BITS = 15 + 16;
+
+
+
+} // no name namespace
+
+
+
+/** \brief Check whether a buffer starts with a gzip header.
+ *
+ * \param[in] data  The data to check.
+ * \param[in] size  The number of bytes in \p data.
+ *
+ * \return true if \p data starts with the gzip magic bytes.
+ */
+bool is_gzip(char const * data, std::size_t size)
+{
+    return size >= 2
+        && static_cast<unsigned char>(data[0]) == 0x1F
+        && static_cast<unsigned char>(data[1]) == 0x8B;
+}
+
+
+/** \brief Decompress the gzip data read from a stream.
+ *
+ * The data is read from \p in in blocks as required.
+ *
+ * \param[in] in  The stream with the compressed data.
+ */
+gzip_istreambuf::gzip_istreambuf(std::istream & in)
+    : f_zstream(std::make_unique<z_stream_s>())
+    , f_in(&in)
+    , f_input(GZIP_BLOCK_SIZE)
+{
+    init();
+}
+
+
+/** \brief Decompress the gzip data found in a buffer.
+ *
+ * The buffer must remain valid as long as the stream buffer is in use.
+ * zlib counts the input in 32 bits so a buffer larger than 4Gb gets
+ * passed to it in several slices.
+ *
+ * \param[in] data  The compressed data.
+ * \param[in] size  The number of bytes in \p data.
+ */
+gzip_istreambuf::gzip_istreambuf(char const * data, std::size_t size)
+    : f_zstream(std::make_unique<z_stream_s>())
+    , f_data(data)
+    , f_size(size)
+{
+    init();
+}
+
+
+/** \brief Release the decompressor.
+ */
+gzip_istreambuf::~gzip_istreambuf()
+{
+    inflateEnd(f_zstream.get());
+}
+
+
+/** \brief Initialize the decompressor.
+ *
+ * \exception compression_error
+ * zlib failed to initialize.
+ */
+void gzip_istreambuf::init()
+{
+    if(inflateInit2(f_zstream.get(), GZIP_WINDOW_BITS) != Z_OK)
+    {
+        throw compression_error("could not initialize the gzip decompressor.");
+    }
+    f_output.resize(GZIP_BLOCK_SIZE);
+    setg(f_output.data(), f_output.data(), f_output.data());
+}
+
+
+/** \brief Read the next block of compressed data.
+ *
+ * With a buffer, the next slice of the buffer is used as is.
+ *
+ * \return false if no more compressed data is available.
+ */
+bool gzip_istreambuf::fill_input()
+{
+    if(f_in == nullptr)
+    {
+        if(f_size == 0)
+        {
+            return false;
+        }
+        std::size_t const size(std::min(f_size, static_cast<std::size_t>(UINT_MAX)));
+        f_zstream->next_in = reinterpret_cast<Bytef *>(const_cast<char *>(f_data));
+        f_zstream->avail_in = static_cast<uInt>(size);
+        f_data += size;
+        f_size -= size;
+        return true;
+    }
+    f_in->read(f_input.data(), f_input.size());
+    std::streamsize const size(f_in->gcount());
+    if(size <= 0)
+    {
+        return false;
+    }
+    f_zstream->next_in = reinterpret_cast<Bytef *>(f_input.data());
+    f_zstream->avail_in = size;
+    return true;
+}
+
+
+/** \brief Decompress the next block of data.
+ *
+ * Several gzip members can follow each other, as with the output of
+ * `cat a.gz b.gz`. They get decompressed as one stream.
+ *
+ * \exception compression_error
+ * The compressed data is invalid or truncated.
+ *
+ * \return The next character or EOF.
+ */
+gzip_istreambuf::int_type gzip_istreambuf::underflow()
+{
+    if(gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    while(!f_done)
+    {
+        if(f_zstream->avail_in == 0
+        && !fill_input())
+        {
+            throw compression_error("the compressed XML data is truncated.");
+        }
+
+        f_zstream->next_out = reinterpret_cast<Bytef *>(f_output.data());
+        f_zstream->avail_out = f_output.size();
+        int const r(inflate(f_zstream.get(), Z_NO_FLUSH));
+        if(r == Z_STREAM_END)
+        {
+            if(f_zstream->avail_in == 0
+            && !fill_input())
+            {
+                f_done = true;
+            }
+            else
+            {
+                inflateReset(f_zstream.get());
+            }
+        }
+        else if(r != Z_OK)
+        {
+            throw compression_error(
+                      std::string("invalid compressed XML data: ")
+                    + (f_zstream->msg == nullptr ? "unknown error" : f_zstream->msg)
+                    + ".");
+        }
+
+        std::size_t const size(f_output.size() - f_zstream->avail_out);
+        if(size > 0)
+        {
+            setg(f_output.data(), f_output.data(), f_output.data() + size);
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+
+    return traits_type::eof();
+}
+
+
+/** \brief Read and decompress gzip data from a stream.
+ *
+ * \param[in] in  The stream with the compressed data.
+ */
+gzip_istream::gzip_istream(std::istream & in)
+    : std::istream(nullptr)
+    , f_buffer(in)
+{
+    rdbuf(&f_buffer);
+}
+
+
+/** \brief Decompress gzip data from a buffer.
+ *
+ * \param[in] data  The compressed data.
+ * \param[in] size  The number of bytes in \p data.
+ */
+gzip_istream::gzip_istream(char const * data, std::size_t size)
+    : std::istream(nullptr)
+    , f_buffer(data, size)
+{
+    rdbuf(&f_buffer);
+}
+
+
+/** \brief Compress data and write it to a stream.
+ *
+ * The data written to this stream buffer is compressed and the result
+ * sent to \p out. Call finish() once done to write the end of the gzip
+ * stream.
+ *
+ * \exception compression_error
+ * zlib failed to initialize.
+ *
+ * \param[in] out  The stream receiving the compressed data.
+ * \param[in] level  The compression level, from 0 to 9, or -1 for the
+ * default level.
+ */
+gzip_ostreambuf::gzip_ostreambuf(std::ostream & out, int level)
+    : f_zstream(std::make_unique<z_stream_s>())
+    , f_out(out)
+    , f_input(GZIP_BLOCK_SIZE)
+    , f_output(GZIP_BLOCK_SIZE)
+{
+    if(deflateInit2(
+              f_zstream.get()
+            , level
+            , Z_DEFLATED
+            , GZIP_WINDOW_BITS
+            , 8
+            , Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw compression_error("could not initialize the gzip compressor.");
+    }
+    setp(f_input.data(), f_input.data() + f_input.size());
+}
+
+
+/** \brief Terminate the compressed stream.
+ *
+ * If finish() was not called yet, the destructor calls it. Errors are
+ * ignored at this point, so call finish() to know whether the whole
+ * data was written.
+ */
+gzip_ostreambuf::~gzip_ostreambuf()
+{
+    try
+    {
+        finish();
+    }
+    catch(std::exception const &)
+    {
+    }
+    deflateEnd(f_zstream.get());
+}
+
+
+/** \brief Write the end of the compressed stream.
+ *
+ * This function compresses the remaining data and writes the gzip
+ * trailer. Nothing more can be written afterward.
+ *
+ * \exception io_error
+ * The output stream failed.
+ */
+void gzip_ostreambuf::finish()
+{
+    if(f_finished)
+    {
+        return;
+    }
+    f_finished = true;
+    deflate_buffer(Z_FINISH);
+    setp(nullptr, nullptr);
+    f_out.flush();
+}
+
+
+/** \brief Compress the buffer once full.
+ *
+ * \param[in] c  The character which did not fit in the buffer.
+ *
+ * \return \p c or EOF if the stream was already finished.
+ */
+gzip_ostreambuf::int_type gzip_ostreambuf::overflow(int_type c)
+{
+    if(f_finished)
+    {
+        return traits_type::eof();
+    }
+    deflate_buffer(Z_NO_FLUSH);
+    if(!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+
+/** \brief Flush the data written so far.
+ *
+ * The pending data gets compressed and written to the output stream so
+ * a reader can decompress everything written so far. Flushing often
+ * reduces the compression ratio.
+ *
+ * \return 0 on success, -1 if the stream was already finished.
+ */
+int gzip_ostreambuf::sync()
+{
+    if(f_finished)
+    {
+        return -1;
+    }
+    deflate_buffer(Z_SYNC_FLUSH);
+    f_out.flush();
+    return f_out ? 0 : -1;
+}
+
+
+/** \brief Compress the data found in the buffer.
+ *
+ * \exception io_error
+ * The output stream failed.
+ *
+ * \param[in] flush  The zlib flush mode.
+ */
+void gzip_ostreambuf::deflate_buffer(int flush)
+{
+    f_zstream->next_in = reinterpret_cast<Bytef *>(pbase());
+    f_zstream->avail_in = pptr() - pbase();
+    do
+    {
+        f_zstream->next_out = reinterpret_cast<Bytef *>(f_output.data());
+        f_zstream->avail_out = f_output.size();
+        deflate(f_zstream.get(), flush);
+        f_out.write(f_output.data(), f_output.size() - f_zstream->avail_out);
+        if(!f_out)
+        {
+            throw io_error("could not write compressed XML data.");
+        }
+    }
+    while(f_zstream->avail_out == 0);
+    setp(f_input.data(), f_input.data() + f_input.size());
+}
+
+
+/** \brief Compress data and write it to a stream.
+ *
+ * \param[in] out  The stream receiving the compressed data.
+ * \param[in] level  The compression level, from 0 to 9, or -1 for the
+ * default level.
+ */
+gzip_ostream::gzip_ostream(std::ostream & out, int level)
+    : std::ostream(nullptr)
+    , f_buffer(out, level)
+{
+    rdbuf(&f_buffer);
+}
+
+
+/** \brief Write the end of the compressed stream.
+ *
+ * \exception io_error
+ * The output stream failed.
+ */
+void gzip_ostream::finish()
+{
+    f_buffer.finish();
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,133 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Compressed XML streams.
+ *
+ * The gzip_istream decompresses gzip data as it gets read and the
+ * gzip_ostream compresses the data written to it. These can be used
+ * with the XML parser and with the node output operator.
+ */
+
+// C++
+//
+#include    <istream>
+#include    <memory>
+#include    <ostream>
+#include    <streambuf>
+#include    <vector>
+
+
+
+struct z_stream_s;
+
+
+
+namespace basic_xml
+{
+
+
+
+bool                                is_gzip(char const * data, std::size_t size);
+
+
+class gzip_istreambuf
+    : public std::streambuf
+{
+public:
+                                    gzip_istreambuf(std::istream & in);
+                                    gzip_istreambuf(char const * data, std::size_t size);
+                                    gzip_istreambuf(gzip_istreambuf const &) = delete;
+    virtual                         ~gzip_istreambuf() override;
+
+    gzip_istreambuf &               operator = (gzip_istreambuf const &) = delete;
+
+protected:
+    virtual int_type                underflow() override;
+
+private:
+    void                            init();
+    bool                            fill_input();
+
+    std::unique_ptr<z_stream_s>     f_zstream{};
+    std::istream *                  f_in = nullptr;
+    char const *                    f_data = nullptr;
+    std::size_t                     f_size = 0;
+    std::vector<char>               f_input = std::vector<char>();
+    std::vector<char>               f_output = std::vector<char>();
+    bool                            f_done = false;
+};
+
+
+class gzip_istream
+    : public std::istream
+{
+public:
+                                    gzip_istream(std::istream & in);
+                                    gzip_istream(char const * data, std::size_t size);
+
+private:
+    gzip_istreambuf                 f_buffer;
+};
+
+
+class gzip_ostreambuf
+    : public std::streambuf
+{
+public:
+                                    gzip_ostreambuf(std::ostream & out, int level = -1);
+                                    gzip_ostreambuf(gzip_ostreambuf const &) = delete;
+    virtual                         ~gzip_ostreambuf() override;
+
+    gzip_ostreambuf &               operator = (gzip_ostreambuf const &) = delete;
+
+    void                            finish();
+
+protected:
+    virtual int_type                overflow(int_type c) override;
+    virtual int                     sync() override;
+
+private:
+    void                            deflate_buffer(int flush);
+
+    std::unique_ptr<z_stream_s>     f_zstream{};
+    std::ostream &                  f_out;
+    std::vector<char>               f_input = std::vector<char>();
+    std::vector<char>               f_output = std::vector<char>();
+    bool                            f_finished = false;
+};
+
+
+class gzip_ostream
+    : public std::ostream
+{
+public:
+                                    gzip_ostream(std::ostream & out, int level = -1);
+
+    void                            finish();
+
+private:
+    gzip_ostreambuf                 f_buffer;
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
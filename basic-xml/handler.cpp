@@ -0,0 +1,195 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the handler.
+ *
+ * The parser calls the functions of a handler in the order in which
+ * the elements appear in the input:
+ *
+ * \code
+ *     <?xml version="1.0"?>         processor("xml version=\"1.0\"")
+ *     <root lang="en">              start_tag("root")
+ *                                   attribute("lang", "en")
+ *       Hello                       text("\n  Hello\n  ")
+ *       <empty/>                    start_tag("empty")
+ *                                   end_tag("empty")
+ *     </root>                       text("\n")
+ *                                   end_tag("root")
+ * \endcode
+ *
+ * Comments are not reported. Entities are already converted in the text
+ * and attribute values. The attributes of a tag are always sent right
+ * after its start_tag() event.
+ *
+ * The strings are views of the parser buffers. Most of the time they
+ * point directly in the input so no copy is made. They are only valid
+ * for the duration of the call; copy them if you need to keep them.
+ *
+ * The default implementation of each function does nothing so you only
+ * need to override the events you are interested in.
+ */
+
+// self
+//
+#include    "basic-xml/handler.h"
+
+#include    "basic-xml/mapped_file.h"
+#include    "basic-xml/parser.h"
+
+
+// snapdev
+//
+#include    <snapdev/not_used.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+/** \brief Clean up the handler.
+ *
+ * The destructor is virtual since the handler is expected to be derived.
+ */
+handler::~handler()
+{
+}
+
+
+/** \brief A tag was opened.
+ *
+ * The attributes of that tag, if any, follow as attribute() events.
+ *
+ * \param[in] name  The name of the tag.
+ */
+void handler::start_tag(std::string_view name)
+{
+    snapdev::NOT_USED(name);
+}
+
+
+/** \brief An attribute of the last opened tag.
+ *
+ * \param[in] name  The name of the attribute.
+ * \param[in] value  The value of the attribute with its entities converted.
+ */
+void handler::attribute(std::string_view name, std::string_view value)
+{
+    snapdev::NOT_USED(name, value);
+}
+
+
+/** \brief Text found inside the current tag.
+ *
+ * The text of one tag may be sent in several events, for example, when
+ * it is broken up by a comment, a CDATA section, or a child tag.
+ *
+ * \param[in] value  The text with its entities converted.
+ */
+void handler::text(std::string_view value)
+{
+    snapdev::NOT_USED(value);
+}
+
+
+/** \brief A tag was closed.
+ *
+ * This event is also sent for empty tags (i.e. `<empty/>`).
+ *
+ * \param[in] name  The name of the tag.
+ */
+void handler::end_tag(std::string_view name)
+{
+    snapdev::NOT_USED(name);
+}
+
+
+/** \brief A processor tag was found.
+ *
+ * Processor tags can only appear before and after the root tag.
+ *
+ * \param[in] value  The content found between the `<?` and `?>`.
+ */
+void handler::processor(std::string_view value)
+{
+    snapdev::NOT_USED(value);
+}
+
+
+/** \brief Parse an XML file and send the events to a handler.
+ *
+ * The file is memory mapped like with the xml object but no tree gets
+ * created. The memory used does not depend on the size of the file.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \param[in] filename  The name of the file to parse.
+ * \param[in] h  The handler receiving the events.
+ * \param[in] options  The limits used while parsing the file.
+ */
+void parse(std::string const & filename, handler & h, parse_options const & options)
+{
+    mapped_file const in(filename);
+    parser p(filename, in.data(), in.size(), h, options);
+    p.parse();
+}
+
+
+/** \brief Parse an XML stream and send the events to a handler.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ * \param[in] h  The handler receiving the events.
+ * \param[in] options  The limits used while parsing the stream.
+ */
+void parse(std::string const & filename, std::istream & in, handler & h, parse_options const & options)
+{
+    parser p(filename, in, h, options);
+    p.parse();
+}
+
+
+/** \brief Parse XML found in memory and send the events to a handler.
+ *
+ * The bytes of \p data are parsed in place. The views passed to the
+ * handler often point directly in \p data.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] data  The XML to parse.
+ * \param[in] h  The handler receiving the events.
+ * \param[in] options  The limits used while parsing the data.
+ */
+void parse(std::string const & filename, std::string_view data, handler & h, parse_options const & options)
+{
+    parser p(filename, data.data(), data.length(), h, options);
+    p.parse();
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
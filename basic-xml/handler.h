@@ -0,0 +1,68 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Events sent by the parser.
+ *
+ * The parser reports what it finds in the XML input to a handler. The
+ * xml object uses a handler which builds a tree of nodes. Your own
+ * handler can instead react to each element as it streams by without
+ * building a tree at all.
+ */
+
+// self
+//
+#include    <basic-xml/parse_options.h>
+
+
+// C++
+//
+#include    <istream>
+#include    <string>
+#include    <string_view>
+
+
+
+namespace basic_xml
+{
+
+
+
+class handler
+{
+public:
+    virtual                         ~handler();
+
+    virtual void                    start_tag(std::string_view name);
+    virtual void                    attribute(std::string_view name, std::string_view value);
+    virtual void                    text(std::string_view value);
+    virtual void                    end_tag(std::string_view name);
+    virtual void                    processor(std::string_view value);
+};
+
+
+void                                parse(std::string const & filename, handler & h, parse_options const & options = parse_options());
+void                                parse(std::string const & filename, std::istream & in, handler & h, parse_options const & options = parse_options());
+void                                parse(std::string const & filename, std::string_view data, handler & h, parse_options const & options = parse_options());
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,213 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the mapped file.
+ *
+ * Loading a file through an std::ifstream means that each character
+ * goes through a virtual function call. Instead we memory map the
+ * whole file and let the parser walk the bytes directly.
+ *
+ * When the file cannot be memory mapped (i.e. it is a pipe or a
+ * character device) we fall back to reading it with read(2) in large
+ * blocks.
+ */
+
+// self
+//
+#include    "basic-xml/mapped_file.h"
+
+#include    "basic-xml/exception.h"
+
+
+// snapdev
+//
+#include    <snapdev/raii_generic_deleter.h>
+
+
+// C
+//
+#include    <fcntl.h>
+#include    <string.h>
+#include    <sys/mman.h>
+#include    <sys/stat.h>
+#include    <unistd.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Size of the blocks read when the file cannot be mapped.
+ *
+ * Pipes and devices cannot be memory mapped. For those, we read the
+ * data in blocks of this size.
+ */
+constexpr std::size_t const     READ_BLOCK_SIZE = 64 * 1024;
+
+
+
+} // no name namespace
+
+
+
+/** \brief Open and map the specified file.
+ *
+ * This function opens the file and, if it is a regular file, maps it
+ * in memory. Otherwise the whole file gets read in a buffer.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \exception io_error
+ * An error occurred while reading the file.
+ *
+ * \param[in] filename  The name of the file to load.
+ */
+mapped_file::mapped_file(std::string const & filename)
+    : f_filename(filename)
+{
+    snapdev::raii_fd_t fd(open(filename.c_str(), O_RDONLY | O_CLOEXEC));
+    if(fd == nullptr)
+    {
+        int const e(errno);
+        throw file_not_found("could not open XML file \""
+                           + filename
+                           + "\": " + strerror(e) + ".");
+    }
+
+    struct stat s;
+    if(fstat(fd.get(), &s) == 0
+    && S_ISREG(s.st_mode))
+    {
+        if(s.st_size == 0)
+        {
+            // mmap() does not accept a size of zero
+            //
+            return;
+        }
+        void * map(mmap(
+                  nullptr
+                , s.st_size
+                , PROT_READ
+                , MAP_PRIVATE
+                , fd.get()
+                , 0));
+        if(map != MAP_FAILED)
+        {
+            madvise(map, s.st_size, MADV_SEQUENTIAL);
+            f_map = map;
+            f_size = s.st_size;
+            return;
+        }
+    }
+
+    read_file(fd.get());
+}
+
+
+/** \brief Release the file data.
+ *
+ * If the file was mapped in memory, this function unmaps it.
+ */
+mapped_file::~mapped_file()
+{
+    if(f_map != nullptr)
+    {
+        munmap(f_map, f_size);
+    }
+}
+
+
+/** \brief Get a pointer to the file data.
+ *
+ * The returned pointer remains valid as long as the mapped_file object
+ * exists.
+ *
+ * \return A pointer to the first byte of the file or nullptr if empty.
+ */
+char const * mapped_file::data() const
+{
+    if(f_map != nullptr)
+    {
+        return reinterpret_cast<char const *>(f_map);
+    }
+    return f_buffer.data();
+}
+
+
+/** \brief Get the size of the file in bytes.
+ *
+ * \return The number of bytes accessible with data().
+ */
+std::size_t mapped_file::size() const
+{
+    return f_size;
+}
+
+
+/** \brief Read the whole file in memory.
+ *
+ * When the file can't be mapped, we read it in a buffer instead. This
+ * is used with pipes and devices (i.e. "/dev/stdin").
+ *
+ * \param[in] fd  The file descriptor to read from.
+ */
+void mapped_file::read_file(int fd)
+{
+    for(;;)
+    {
+        f_buffer.resize(f_size + READ_BLOCK_SIZE);
+        ssize_t const r(read(fd, f_buffer.data() + f_size, READ_BLOCK_SIZE));
+        if(r < 0)
+        {
+            int const e(errno);
+            if(e == EINTR)
+            {
+                continue;
+            }
+            throw io_error("could not read XML file \""
+                         + f_filename
+                         + "\": " + strerror(e) + ".");
+        }
+        if(r == 0)
+        {
+            break;
+        }
+        f_size += r;
+    }
+    f_buffer.resize(f_size);
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,65 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Access the content of a file as one contiguous buffer.
+ *
+ * The mapped_file object gives the parser direct access to all the
+ * bytes of a file. Regular files are memory mapped. Other files (pipes,
+ * character devices, etc.) get read in memory with read(2).
+ */
+
+// C++
+//
+#include    <string>
+#include    <vector>
+
+
+
+namespace basic_xml
+{
+
+
+
+class mapped_file
+{
+public:
+                        mapped_file(std::string const & filename);
+                        mapped_file(mapped_file const &) = delete;
+                        ~mapped_file();
+
+    mapped_file &       operator = (mapped_file const &) = delete;
+
+    char const *        data() const;
+    std::size_t         size() const;
+
+private:
+    void                read_file(int fd);
+
+    std::string         f_filename = std::string();
+    void *              f_map = nullptr;
+    std::size_t         f_size = 0;
+    std::vector<char>   f_buffer = std::vector<char>();
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
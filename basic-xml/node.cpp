@@ -31,6 +31,7 @@
 //
 #include    "basic-xml/node.h"
 
+#include    "basic-xml/entities.h"
 #include    "basic-xml/exception.h"
 #include    "basic-xml/type.h"
 
@@ -44,6 +45,7 @@
 
 // C++
 //
+#include    <cstring>
 #include    <iomanip>
 
 
@@ -58,19 +60,95 @@ namespace basic_xml
 
 
 
+namespace
+{
+
+
+
+/** \brief Set the value of an attribute.
+ *
+ * The attributes are saved in a map using the memory resource of the
+ * node. Searching it with a std::string_view avoids creating a
+ * temporary key.
+ *
+ * \param[in,out] attributes  The map of attributes.
+ * \param[in] name  The name of the attribute.
+ * \param[in] value  The new value of the attribute.
+ */
+template<typename M>
+void save_attribute(M & attributes, std::string_view name, std::string_view value)
+{
+    auto const it(attributes.find(name));
+    if(it == attributes.end())
+    {
+        attributes.emplace(name, value);
+    }
+    else
+    {
+        it->second = value;
+    }
+}
+
+
+
+} // no name namespace
+
+
+
 node::node(std::string const & name)
+    : node(name, std::pmr::get_default_resource())
+{
+}
+
+
+/** \brief Create a node allocating its data from a memory resource.
+ *
+ * The text and the attributes of the node get allocated from \p resource.
+ * The tree builder uses this constructor to allocate all the nodes of a
+ * document from one arena. The resource must remain valid as long as
+ * the node exists.
+ *
+ * \exception invalid_token
+ * The name is not a valid token.
+ *
+ * \param[in] name  The name of the tag.
+ * \param[in] resource  The memory resource used by the text and attributes.
+ */
+node::node(std::string_view name, std::pmr::memory_resource * resource)
     : f_name(name)
+    , f_text(resource)
+    , f_attributes(resource)
+    , f_raw_attributes(resource)
 {
-    if(!is_token(name))
+    if(!is_token(name.data(), name.length()))
     {
         throw invalid_token(
                   "\""
-                + snapdev::string_replace_many(name, {{std::string("\0", 1), "\\0"}})
+                + snapdev::string_replace_many(f_name, {{std::string("\0", 1), "\\0"}})
                 + "\" is not a valid token for a tag name.");
     }
 }
 
 
+/** \brief Release the children of this node.
+ *
+ * The siblings are linked with shared pointers so releasing the first
+ * child would otherwise release the next one recursively. With many
+ * children, that recursion could overflow the stack. Instead, the list
+ * is released in a loop.
+ */
+node::~node()
+{
+    pointer_t n(std::move(f_child));
+    while(n != nullptr
+       && n.use_count() == 1)
+    {
+        pointer_t next(std::move(n->f_next));
+        n = std::move(next);
+    }
+}
+
+
 std::string const & node::tag_name() const
 {
     return f_name;
@@ -79,40 +157,74 @@ std::string const & node::tag_name() const
 
 std::string node::text(bool trim) const
 {
+    decode();
+    std::string const result(f_text);
     if(trim)
     {
-        return snapdev::trim_string(f_text);
+        return snapdev::trim_string(result);
     }
-    return f_text;
+    return result;
 }
 
 
 void node::set_text(std::string const & text)
 {
+    f_raw_text = std::string::npos;
     f_text = text;
 }
 
 
 void node::append_text(std::string const & text)
 {
+    decode();
     f_text += text;
 }
 
 
 node::attribute_map_t node::all_attributes() const
 {
-    return f_attributes;
+    decode();
+    attribute_map_t result;
+    for(auto const & a : f_attributes)
+    {
+        result.emplace_hint(result.end(), a.first, a.second);
+    }
+    return result;
 }
 
 
 std::string node::attribute(std::string const & name) const
 {
-    auto const it(f_attributes.find(name));
-    if(it == f_attributes.end())
+    auto const it(f_attributes.find(std::string_view(name)));
+    if(it != f_attributes.end())
     {
-        return std::string();
+        return std::string(it->second);
     }
-    return it->second;
+
+    // in lazy mode, search the raw attributes without creating the map,
+    // the decoded value gets cached in the map for the next calls
+    //
+    char const * s(f_raw_attributes.data());
+    char const * const end(s + f_raw_attributes.length());
+    while(s < end)
+    {
+        std::size_t const name_length(strlen(s));
+        char const * const value(s + name_length + 1);
+        std::size_t const value_length(strlen(value));
+        if(name.compare(0, std::string::npos, s, name_length) == 0)
+        {
+            std::string result(value, value_length);
+            if(memchr(value, '&', value_length) != nullptr)
+            {
+                result.resize(unescape_entities(result.data(), result.length(), [this]() { return "tag \"" + f_name + '"'; }));
+            }
+            save_attribute(f_attributes, name, result);
+            return result;
+        }
+        s = value + value_length + 1;
+    }
+
+    return std::string();
 }
 
 
@@ -122,7 +234,161 @@ void node::set_attribute(std::string const & name, std::string const & value)
     {
         throw invalid_token("\"" + name + "\" is not a valid token for an attribute name.");
     }
-    f_attributes[name] = value;
+    decode();
+    save_attribute(f_attributes, name, value);
+}
+
+
+/** \brief Add an attribute found by the parser.
+ *
+ * This function is used by the tree builder to save an attribute of
+ * which the entities were already decoded. It avoids creating temporary
+ * strings.
+ *
+ * \exception invalid_token
+ * The name of the attribute is not a valid token.
+ *
+ * \param[in] name  The name of the attribute.
+ * \param[in] value  The value of the attribute.
+ */
+void node::append_parsed_attribute(std::string_view name, std::string_view value)
+{
+    if(!is_token(name.data(), name.length()))
+    {
+        throw invalid_token("\"" + std::string(name) + "\" is not a valid token for an attribute name.");
+    }
+    decode();
+    save_attribute(f_attributes, name, value);
+}
+
+
+/** \brief Append text found by the parser.
+ *
+ * This function is used by the tree builder to append text of which the
+ * entities were already decoded.
+ *
+ * \param[in] text  The text to append.
+ */
+void node::append_parsed_text(std::string_view text)
+{
+    decode();
+    f_text += text;
+}
+
+
+/** \brief Add an attribute without decoding its entities.
+ *
+ * In lazy mode, the tree builder saves the attributes as found in the
+ * input. They all get saved in one string, each name and value followed
+ * by a '\0', which is much faster than creating the map of attributes.
+ * attribute() searches that string directly and caches the decoded
+ * value in the map. The other functions first create the map and decode
+ * all the entities.
+ *
+ * A value which includes a '\0' cannot be saved that way so it gets
+ * decoded immediately.
+ *
+ * \exception invalid_token
+ * The name of the attribute is not a valid token.
+ *
+ * \param[in] name  The name of the attribute.
+ * \param[in] value  The value of the attribute, with its entities.
+ */
+void node::append_raw_attribute(std::string_view name, std::string_view value)
+{
+    if(!is_token(name.data(), name.length()))
+    {
+        throw invalid_token("\"" + std::string(name) + "\" is not a valid token for an attribute name.");
+    }
+    if(memchr(value.data(), '\0', value.length()) != nullptr)
+    {
+        decode();
+        std::string v(value);
+        v.resize(unescape_entities(v.data(), v.length(), [this]() { return "tag \"" + f_name + '"'; }));
+        save_attribute(f_attributes, name, v);
+        return;
+    }
+    f_raw_attributes += name;
+    f_raw_attributes += '\0';
+    f_raw_attributes += value;
+    f_raw_attributes += '\0';
+}
+
+
+/** \brief Append text without decoding its entities.
+ *
+ * In lazy mode, the tree builder saves the text as found in the input
+ * and the entities get decoded on the first access. Each piece of text
+ * must be decoded on its own, so the text pending decoding is decoded
+ * before a new piece gets appended.
+ *
+ * \param[in] text  The text to append, with its entities.
+ */
+void node::append_raw_text(std::string_view text)
+{
+    if(f_raw_text != std::string::npos)
+    {
+        decode();
+    }
+    if(memchr(text.data(), '&', text.length()) != nullptr)
+    {
+        f_raw_text = f_text.length();
+    }
+    f_text += text;
+}
+
+
+/** \brief Decode the data saved in lazy mode.
+ *
+ * This function decodes the entities of the text and attributes which
+ * were saved without being decoded. It is called by all the functions
+ * accessing the text or the attributes.
+ *
+ * Since the input is not available anymore, the errors mention the
+ * tag name instead of the filename and line number.
+ *
+ * \warning
+ * The first access to a node loaded in lazy mode modifies it. Do not
+ * read the same node from several threads before it was accessed once.
+ *
+ * \exception invalid_entity
+ * An entity is not valid.
+ *
+ * \exception invalid_number
+ * A numeric entity does not represent a valid Unicode character.
+ */
+void node::decode() const
+{
+    if(f_raw_text != std::string::npos)
+    {
+        std::string raw(f_text.data() + f_raw_text, f_text.length() - f_raw_text);
+        raw.resize(unescape_entities(raw.data(), raw.length(), [this]() { return "tag \"" + f_name + '"'; }));
+        f_text.replace(f_raw_text, std::string::npos, raw.data(), raw.length());
+        f_raw_text = std::string::npos;
+    }
+
+    if(!f_raw_attributes.empty())
+    {
+        attribute_storage_t attributes(f_attributes, f_attributes.get_allocator());
+        char * s(f_raw_attributes.data());
+        char const * const end(s + f_raw_attributes.length());
+        while(s < end)
+        {
+            std::size_t const name_length(strlen(s));
+            char const * const name(s);
+            s += name_length + 1;
+            std::size_t const value_length(strlen(s));
+            std::string value(s, value_length);
+            if(memchr(s, '&', value_length) != nullptr)
+            {
+                value.resize(unescape_entities(value.data(), value.length(), [this]() { return "tag \"" + f_name + '"'; }));
+            }
+            save_attribute(attributes, std::string_view(name, name_length), value);
+            s += value_length + 1;
+        }
+        f_attributes.swap(attributes);
+        f_raw_attributes.clear();
+    }
 }
 
 
@@ -149,6 +415,7 @@ void node::append_child(pointer_t n)
         l->f_next = n;
         n->f_previous = l;
     }
+    f_last_child = n;
 
     n->f_parent = shared_from_this();
 }
@@ -185,18 +452,7 @@ node::pointer_t node::first_child() const
 
 node::pointer_t node::last_child() const
 {
-    if(f_child == nullptr)
-    {
-        return node::pointer_t();
-    }
-
-    pointer_t l(f_child);
-    while(l->f_next != nullptr)
-    {
-        l = l->f_next;
-    }
-
-    return l;
+    return f_last_child.lock();
 }
 
 
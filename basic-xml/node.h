@@ -24,12 +24,20 @@
  * The following declares the basic XML node object.
  */
 
+// self
+//
+#include    <basic-xml/parse_options.h>
+
+
 // C++
 //
 #include    <deque>
 #include    <map>
 #include    <memory>
+#include    <memory_resource>
 #include    <ostream>
+#include    <string>
+#include    <string_view>
 #include    <vector>
 
 
@@ -39,6 +47,9 @@ namespace basic_xml
 
 
 
+class tree_builder;
+
+
 class node
     : public std::enable_shared_from_this<node>
 {
@@ -53,6 +64,8 @@ public:
     typedef std::deque<pointer_t>   deque_t;
 
                                     node(std::string const & name);
+                                    node(std::string_view name, std::pmr::memory_resource * resource);
+                                    ~node();
 
     std::string const &             tag_name() const;
     std::string                     text(bool trim = true) const;
@@ -71,14 +84,32 @@ public:
     pointer_t                       previous() const;
 
 private:
+    friend class tree_builder;
+
+    typedef std::pmr::map<std::pmr::string, std::pmr::string, std::less<>>
+                                    attribute_storage_t;
+
+    void                            append_parsed_attribute(std::string_view name, std::string_view value);
+    void                            append_parsed_text(std::string_view text);
+    void                            append_raw_attribute(std::string_view name, std::string_view value);
+    void                            append_raw_text(std::string_view text);
+    void                            decode() const;
+
+    // tag_name() returns an std::string so the name does not use the
+    // memory resource; short names fit in the node itself anyway
     std::string const               f_name;
-    std::string                     f_text = std::string();
-    attribute_map_t                 f_attributes = attribute_map_t();
+
+    // in lazy mode, the entities get decoded on the first access
+    mutable std::pmr::string        f_text = std::pmr::string();
+    mutable std::string::size_type  f_raw_text = std::string::npos;
+    mutable attribute_storage_t     f_attributes = attribute_storage_t();
+    mutable std::pmr::string        f_raw_attributes = std::pmr::string();
 
     pointer_t                       f_next = pointer_t();
     weak_pointer_t                  f_previous = weak_pointer_t();
 
     pointer_t                       f_child = pointer_t();
+    weak_pointer_t                  f_last_child = weak_pointer_t();
     weak_pointer_t                  f_parent = weak_pointer_t();
 };
 
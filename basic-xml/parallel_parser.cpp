@@ -0,0 +1,484 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the parallel parser.
+ *
+ * The parallel parser first reads the prolog and the root start tag.
+ * Then it speculatively splits the content of the root tag in chunks,
+ * each starting with what looks like a start tag with the same name as
+ * the first child of the root tag, and parses each chunk in a separate
+ * thread. A thread stops once it closed all the tags it
+ * opened at or after the start of the next chunk.
+ *
+ * The guess is verified once all the threads are done: a chunk is only
+ * used if the previous chunk ended exactly where it starts. When the
+ * split landed somewhere else (inside a comment, a CDATA section, or a
+ * child tag) or a chunk found an error, the rest of the content is
+ * parsed again in the current thread, which also gives the correct line
+ * number in error messages.
+ */
+
+// self
+//
+#include    "basic-xml/parallel_parser.h"
+
+#include    "basic-xml/parser.h"
+#include    "basic-xml/tree_builder.h"
+#include    "basic-xml/type.h"
+#include    "basic-xml/utf16.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <cstring>
+#include    <exception>
+#include    <string_view>
+#include    <thread>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Minimum number of bytes parsed by one thread.
+ *
+ * Starting a thread for a small amount of data is slower than parsing
+ * it directly. Each chunk is at least this size.
+ */
+constexpr std::size_t const     MINIMUM_CHUNK_SIZE = 256 * 1024;
+
+
+
+/** \brief Handler collecting the children of the root tag.
+ *
+ * Each chunk of the root content gets parsed with this handler. It
+ * builds the children of the root tag as separate trees and saves the
+ * text found directly in the root.
+ */
+class fragment_builder
+    : public handler
+{
+public:
+    virtual void start_tag(std::string_view name) override
+    {
+        f_builder.start_tag(name);
+        ++f_depth;
+    }
+
+    virtual void attribute(std::string_view name, std::string_view value) override
+    {
+        f_builder.attribute(name, value);
+    }
+
+    virtual void text(std::string_view value) override
+    {
+        if(f_depth == 0)
+        {
+            f_text += value;
+        }
+        else
+        {
+            f_builder.text(value);
+        }
+    }
+
+    virtual void end_tag(std::string_view name) override
+    {
+        if(f_depth == 0)
+        {
+            // end of the root tag
+            //
+            return;
+        }
+        f_builder.end_tag(name);
+        --f_depth;
+        if(f_depth == 0)
+        {
+            f_children.push_back(f_child);
+        }
+    }
+
+    std::size_t depth() const
+    {
+        return f_depth;
+    }
+
+    void graft(node::pointer_t root) const
+    {
+        for(auto const & c : f_children)
+        {
+            root->append_child(c);
+        }
+        root->append_text(f_text);
+    }
+
+private:
+    node::pointer_t         f_child = node::pointer_t();
+    tree_builder            f_builder = tree_builder(f_child);
+    std::size_t             f_depth = 0;
+    node::vector_t          f_children = node::vector_t();
+    std::string             f_text = std::string();
+};
+
+
+/** \brief The result of parsing one chunk.
+ */
+struct chunk_t
+{
+    char const *            f_start = nullptr;
+    char const *            f_limit = nullptr;
+    char const *            f_end = nullptr;
+    bool                    f_done = false;
+    std::exception_ptr      f_error = std::exception_ptr();
+    fragment_builder        f_fragment = fragment_builder();
+};
+
+
+/** \brief Join the threads parsing the chunks.
+ *
+ * Destroying an std::thread which was not joined calls std::terminate().
+ * This object joins the threads when leaving the block, including when
+ * creating a thread or parsing the first chunk throws.
+ */
+class join_threads
+{
+public:
+    join_threads(std::vector<std::thread> & threads)
+        : f_threads(threads)
+    {
+    }
+
+    join_threads(join_threads const &) = delete;
+    join_threads & operator = (join_threads const &) = delete;
+
+    ~join_threads()
+    {
+        for(auto & t : f_threads)
+        {
+            t.join();
+        }
+    }
+
+private:
+    std::vector<std::thread> &  f_threads;
+};
+
+
+/** \brief Parse one chunk.
+ *
+ * The parser stops once it is back at the level of the root tag and
+ * reached the start of the next chunk. The last chunk has no limit and
+ * gets parsed up to the end of the input, which includes the root end
+ * tag and the epilog.
+ *
+ * \param[in] context  The parser which read the root start tag.
+ * \param[in,out] chunk  The chunk to parse.
+ */
+void parse_chunk(parser const & context, chunk_t & chunk)
+{
+    try
+    {
+        parser p(context, chunk.f_start, chunk.f_fragment);
+        for(;;)
+        {
+            if(!p.step())
+            {
+                chunk.f_done = true;
+                break;
+            }
+            if(chunk.f_limit != nullptr
+            && chunk.f_fragment.depth() == 0
+            && p.position() >= chunk.f_limit)
+            {
+                break;
+            }
+        }
+        chunk.f_end = p.position();
+    }
+    catch(...)
+    {
+        chunk.f_error = std::current_exception();
+    }
+}
+
+
+/** \brief Check whether a byte can be part of a tag name.
+ *
+ * Bytes of UTF-8 multi-byte characters are all viewed as name characters.
+ * The parser verifies the names anyway.
+ *
+ * \param[in] c  The byte to check.
+ *
+ * \return true if \p c can appear in a tag name.
+ */
+bool is_name_byte(char c)
+{
+    unsigned char const b(c);
+    return b >= 0x80 || is_name_char(b);
+}
+
+
+/** \brief Get the name of the first child of the root tag.
+ *
+ * Large documents are generally a list of similar records. This function
+ * reads the name of the first child so the chunks can start on a tag
+ * with the same name, which is very likely a child of the root tag.
+ *
+ * Comments, CDATA sections, and processor instructions are skipped.
+ *
+ * \param[in] s  The start of the content of the root tag.
+ * \param[in] e  The end of the input.
+ *
+ * \return The name of the first child or an empty string.
+ */
+std::string first_child_name(char const * s, char const * e)
+{
+    for(;;)
+    {
+        s = static_cast<char const *>(memchr(s, '<', e - s));
+        if(s == nullptr)
+        {
+            return std::string();
+        }
+        std::string_view const rest(s, e - s);
+        std::size_t skip(0);
+        if(rest.substr(0, 4) == "<!--")
+        {
+            skip = rest.find("-->", 4);
+        }
+        else if(rest.substr(0, 9) == "<![CDATA[")
+        {
+            skip = rest.find("]]>", 9);
+        }
+        else if(rest.substr(0, 2) == "<?")
+        {
+            skip = rest.find("?>", 2);
+        }
+        else
+        {
+            char const * n(s + 1);
+            while(n < e && is_name_byte(*n))
+            {
+                ++n;
+            }
+            return std::string(s + 1, n);
+        }
+        if(skip == std::string_view::npos)
+        {
+            return std::string();
+        }
+        s += skip;
+    }
+}
+
+
+/** \brief Find a possible start of chunk.
+ *
+ * This function searches for a start tag named \p name and preceded
+ * by a '>' (possibly with spaces in between). The previous tag must not
+ * be the end of a comment since the parser reads a comment along the
+ * next token.
+ *
+ * \param[in] s  Where the search starts.
+ * \param[in] e  The end of the input.
+ * \param[in] name  The name of the first child of the root tag.
+ *
+ * \return The position of the '<' or \p e if none was found.
+ */
+char const * find_split(char const * s, char const * e, std::string const & name)
+{
+    for(;;)
+    {
+        s = static_cast<char const *>(memchr(s, '<', e - s));
+        if(s == nullptr
+        || static_cast<std::size_t>(e - s) < name.length() + 2)
+        {
+            return e;
+        }
+        if(name.compare(0, name.length(), s + 1, name.length()) == 0
+        && !is_name_byte(s[name.length() + 1]))
+        {
+            char const * p(s);
+            while(p > s - 64
+               && is_space(static_cast<unsigned char>(p[-1])))
+            {
+                --p;
+            }
+            if(p[-1] == '>'
+            && (p[-2] != '-' || p[-3] != '-'))
+            {
+                return s;
+            }
+        }
+        ++s;
+    }
+}
+
+
+
+} // no name namespace
+
+
+
+/** \brief Parse a buffer using several threads.
+ *
+ * This constructor parses the \p size bytes at \p data and saves the
+ * resulting tree in \p root. The content of the root tag is split in up
+ * to \p thread_count chunks parsed in parallel. A small document or
+ * a \p thread_count of 1 gets parsed in the current thread only.
+ *
+ * The result is exactly the same as with the parser, including the
+ * error messages. Compressed data is parsed in the current thread.
+ *
+ * \param[in] filename  The name of the file, used in error messages.
+ * \param[in] data  A pointer to the XML data.
+ * \param[in] size  The number of bytes in \p data.
+ * \param[out] root  The pointer where the root node gets saved.
+ * \param[in] thread_count  The maximum number of threads to use; 0 means
+ * one per CPU.
+ */
+parallel_parser::parallel_parser(
+          std::string const & filename
+        , char const * data
+        , std::size_t size
+        , node::pointer_t & root
+        , std::size_t thread_count)
+{
+    if(thread_count == 0)
+    {
+        thread_count = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    // compressed and UTF-16 data can only be decoded sequentially
+    //
+    if(is_gzip(data, size)
+    || is_utf16(data, size))
+    {
+        parser p(filename, data, size, root);
+        return;
+    }
+
+    // read the prolog and the root start tag
+    //
+    tree_builder builder(root);
+    parser p(filename, data, size, builder);
+    while(root == nullptr)
+    {
+        p.step();
+    }
+
+    char const * const content(p.position());
+    char const * const end(data + size);
+    std::size_t const chunk_size(std::max(
+              MINIMUM_CHUNK_SIZE
+            , static_cast<std::size_t>(end - content) / thread_count + 1));
+    if(thread_count <= 1
+    || static_cast<std::size_t>(end - content) < chunk_size * 2)
+    {
+        p.parse();
+        return;
+    }
+
+    std::string const name(first_child_name(content, end));
+    if(name.empty())
+    {
+        p.parse();
+        return;
+    }
+
+    std::vector<char const *> splits(1, content);
+    while(splits.size() < thread_count
+       && static_cast<std::size_t>(end - splits.back()) > chunk_size)
+    {
+        char const * const s(find_split(splits.back() + chunk_size, end, name));
+        if(static_cast<std::size_t>(end - s) < chunk_size / 2)
+        {
+            break;
+        }
+        splits.push_back(s);
+    }
+    // the last chunk has no limit, it parses up to the end of the input
+    //
+    splits.push_back(nullptr);
+
+    // the fragment builders reference their own node, so the chunks
+    // must be created in place and never moved
+    //
+    std::vector<chunk_t> chunks(splits.size() - 1);
+    for(std::size_t idx(0); idx < chunks.size(); ++idx)
+    {
+        chunks[idx].f_start = splits[idx];
+        chunks[idx].f_limit = splits[idx + 1];
+    }
+
+    {
+        std::vector<std::thread> threads;
+        join_threads const join(threads);
+        threads.reserve(chunks.size() - 1);
+        for(std::size_t idx(1); idx < chunks.size(); ++idx)
+        {
+            threads.emplace_back(parse_chunk, std::cref(p), std::ref(chunks[idx]));
+        }
+        parse_chunk(p, chunks[0]);
+    }
+
+    // graft the chunks which started where the previous one ended
+    //
+    char const * pos(content);
+    for(auto const & c : chunks)
+    {
+        if(c.f_start != pos
+        || c.f_error != nullptr)
+        {
+            break;
+        }
+        c.f_fragment.graft(root);
+        pos = c.f_end;
+        if(c.f_done)
+        {
+            return;
+        }
+    }
+
+    // the speculation failed, parse the rest in this thread
+    //
+    fragment_builder rest;
+    parser r(p, pos, rest);
+    r.parse();
+    rest.graft(root);
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,54 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Parse one large XML buffer with several threads.
+ *
+ * The parallel_parser splits the content of the root tag between
+ * threads and grafts the resulting sub-trees under the root in
+ * document order.
+ */
+
+// self
+//
+#include    <basic-xml/node.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+class parallel_parser
+{
+public:
+                        parallel_parser(
+                              std::string const & filename
+                            , char const * data
+                            , std::size_t size
+                            , node::pointer_t & root
+                            , std::size_t thread_count);
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,70 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Options used to parse an XML document.
+ *
+ * The parse options define how the entities get decoded and the limits
+ * used to protect the process against documents from untrusted sources.
+ */
+
+// C++
+//
+#include    <cstddef>
+
+
+
+namespace basic_xml
+{
+
+
+
+enum class decode_t
+{
+    DECODE_NOW,
+    DECODE_LAZY
+};
+
+
+struct parse_options
+{
+    // only used when building a tree, handlers always get decoded values
+    //
+    decode_t                        f_decode = decode_t::DECODE_NOW;
+
+    // only used when building a tree, allocate the nodes from one arena
+    //
+    bool                            f_use_arena = false;
+
+    // limits, 0 means unlimited; going over a limit raises limit_exceeded
+    //
+    std::size_t                     f_max_depth = 0;                // nesting of the tags, the root is 1
+    std::size_t                     f_max_size = 0;                 // bytes of input (after decompression)
+    std::size_t                     f_max_nodes = 0;                // number of tags
+    std::size_t                     f_max_attributes = 0;           // attributes per tag
+    std::size_t                     f_max_attribute_length = 0;     // bytes in one attribute value
+    std::size_t                     f_max_text_length = 0;          // bytes in one block of text
+    std::size_t                     f_max_memory = 0;               // estimated bytes to hold the data
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
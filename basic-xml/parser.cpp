@@ -28,8 +28,17 @@
 //
 #include    "basic-xml/parser.h"
 
+#include    "basic-xml/entities.h"
 #include    "basic-xml/exception.h"
+#include    "basic-xml/scan.h"
+#include    "basic-xml/tree_builder.h"
 #include    "basic-xml/type.h"
+#include    "basic-xml/utf16.h"
+
+
+// C++
+//
+#include    <cstring>
 
 
 // libutf8
@@ -41,7 +50,7 @@
 // snapdev
 //
 #include    <snapdev/not_reached.h>
-#include    <snapdev/trim_string.h>
+#include    <snapdev/string_replace_many.h>
 
 
 // last include
@@ -55,168 +64,781 @@ namespace basic_xml
 
 
 
+namespace
+{
+
+
+
+/** \brief Size of the blocks read from an input stream.
+ *
+ * When reading from an std::istream, the parser reads the data in
+ * blocks of this size.
+ */
+constexpr std::size_t const     INPUT_BLOCK_SIZE = 64 * 1024;
+
+
+/** \brief Estimated memory used by one attribute.
+ *
+ * The memory limit is verified against an estimate of the memory used
+ * by the parsed data. Each attribute costs its name and value plus this
+ * amount for the map entry and string headers.
+ */
+constexpr std::size_t const     ATTRIBUTE_OVERHEAD = 128;
+
+
+
+} // no name namespace
+
+
+
+/** \brief Parse the XML found in a stream and build a tree.
+ *
+ * This constructor reads the XML from \p in and saves the resulting
+ * tree of nodes in \p root.
+ *
+ * \param[in] filename  The name of the file, used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ * \param[out] root  The pointer where the root node gets saved.
+ * \param[in] options  The options used to parse the input.
+ */
 parser::parser(
           std::string const & filename
         , std::istream & in
-        , node::pointer_t & root)
+        , node::pointer_t & root
+        , parse_options const & options)
     : f_filename(filename)
-    , f_in(in)
+    , f_builder(std::make_unique<tree_builder>(root, options.f_decode, options.f_use_arena))
+    , f_handler(f_builder.get())
+    , f_options(options)
+    , f_in(&in)
+    , f_buffer(INPUT_BLOCK_SIZE)
+    , f_begin(f_buffer.data())
+    , f_pos(f_begin)
+    , f_valid(f_begin)
+    , f_end(f_begin)
+    , f_line_ptr(f_begin)
 {
-    load(root);
+    load();
 }
 
 
-/** \brief Load the XML as node in \p root.
+/** \brief Parse the XML found in a buffer and build a tree.
+ *
+ * This constructor parses the \p size bytes found at \p data. The buffer
+ * is read directly, without going through an std::istream, which is much
+ * faster. This is used with memory mapped files.
+ *
+ * The buffer must remain valid until the constructor returns.
+ *
+ * If the buffer starts with a gzip header, the data gets decompressed
+ * in blocks as the parser goes. If it starts with a UTF-16 byte order
+ * mark, it gets converted to UTF-8 in blocks the same way.
  *
- * This function loads what it considers valid XML.
+ * \exception invalid_utf8
+ * The whole buffer is validated before parsing starts. If it includes
+ * an invalid UTF-8 sequence, this exception is raised.
  *
- * \param[out] root  A reference to the root pointer where the results are saved.
+ * \param[in] filename  The name of the file, used in error messages.
+ * \param[in] data  A pointer to the XML data.
+ * \param[in] size  The number of bytes in \p data.
+ * \param[out] root  The pointer where the root node gets saved.
+ * \param[in] options  The options used to parse the input.
  */
-void parser::load(node::pointer_t & root)
+parser::parser(
+          std::string const & filename
+        , char const * data
+        , std::size_t size
+        , node::pointer_t & root
+        , parse_options const & options)
+    : f_filename(filename)
+    , f_builder(std::make_unique<tree_builder>(root, options.f_decode, options.f_use_arena))
+    , f_handler(f_builder.get())
+    , f_options(options)
+    , f_begin(data)
+    , f_pos(data)
+    , f_valid(data)
+    , f_end(data + size)
+    , f_line_ptr(data)
 {
-    token_t tok(get_token(false));
-
-    tok = skip_empty(tok);
-    if(tok == token_t::TOK_PROCESSOR) // allow <?xml ... ?>
+    if(is_gzip(data, size))
     {
-        tok = get_token(false);
+        read_from(std::make_unique<gzip_istream>(data, size));
     }
-    tok = skip_empty(tok);
+    else if(is_utf16(data, size))
+    {
+        read_from(std::make_unique<utf16_istream>(data, size));
+    }
+    else
+    {
+        validate_input(false);
+    }
+    load();
+}
+
+
+/** \brief Create a push parser building a tree.
+ *
+ * This constructor prepares a parser which receives its input in chunks
+ * through the feed() functions. The tree is built as the data arrives.
+ * Once all the data was sent, call finish().
+ *
+ * \param[in] filename  The name of the file, used in error messages.
+ * \param[out] root  The pointer where the root node gets saved.
+ * \param[in] options  The options used to parse the input.
+ */
+parser::parser(
+          std::string const & filename
+        , node::pointer_t & root
+        , parse_options const & options)
+    : f_filename(filename)
+    , f_builder(std::make_unique<tree_builder>(root, options.f_decode, options.f_use_arena))
+    , f_handler(f_builder.get())
+    , f_options(options)
+    , f_finished(false)
+{
+}
+
 
-    // now we have to have the root tag
+/** \brief Prepare to parse a stream and send events to a handler.
+ *
+ * This constructor is similar to the one building a tree except that
+ * each element found in the input is sent to the handler \p h instead.
+ *
+ * The constructor does not parse anything. Call parse() to parse the
+ * whole input or step() to parse it one token at a time.
+ *
+ * \param[in] filename  The name of the file, used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ * \param[in] h  The handler receiving the events.
+ * \param[in] options  The options used to parse the input.
+ */
+parser::parser(
+          std::string const & filename
+        , std::istream & in
+        , handler & h
+        , parse_options const & options)
+    : f_filename(filename)
+    , f_handler(&h)
+    , f_options(options)
+    , f_in(&in)
+    , f_buffer(INPUT_BLOCK_SIZE)
+    , f_begin(f_buffer.data())
+    , f_pos(f_begin)
+    , f_valid(f_begin)
+    , f_end(f_begin)
+    , f_line_ptr(f_begin)
+{
+    // a handler always receives decoded values
     //
-    if(tok != token_t::TOK_OPEN_TAG)
+    f_options.f_decode = decode_t::DECODE_NOW;
+}
+
+
+/** \brief Prepare to parse a buffer and send events to a handler.
+ *
+ * The constructor validates the buffer but does not parse anything.
+ * Call parse() to parse the whole input or step() to parse it one token
+ * at a time.
+ *
+ * If the buffer starts with a gzip header, the data gets decompressed
+ * in blocks as the parser goes. If it starts with a UTF-16 byte order
+ * mark, it gets converted to UTF-8 in blocks the same way.
+ *
+ * \exception invalid_utf8
+ * The whole buffer is validated before parsing starts. If it includes
+ * an invalid UTF-8 sequence, this exception is raised.
+ *
+ * \param[in] filename  The name of the file, used in error messages.
+ * \param[in] data  A pointer to the XML data.
+ * \param[in] size  The number of bytes in \p data.
+ * \param[in] h  The handler receiving the events.
+ * \param[in] options  The options used to parse the input.
+ */
+parser::parser(
+          std::string const & filename
+        , char const * data
+        , std::size_t size
+        , handler & h
+        , parse_options const & options)
+    : f_filename(filename)
+    , f_handler(&h)
+    , f_options(options)
+    , f_begin(data)
+    , f_pos(data)
+    , f_valid(data)
+    , f_end(data + size)
+    , f_line_ptr(data)
+{
+    f_options.f_decode = decode_t::DECODE_NOW;
+
+    if(is_gzip(data, size))
     {
-        throw unexpected_token(
-                  f_filename
-                + ':'
-                + std::to_string(f_line)
-                + ": cannot be empty or include anything other than a processor tag and comments before the root tag.");
+        read_from(std::make_unique<gzip_istream>(data, size));
     }
-    root = std::make_shared<node>(f_value);
-    if(read_tag_attributes(root) == token_t::TOK_EMPTY_TAG)
+    else if(is_utf16(data, size))
     {
-        throw unexpected_token(
-                  f_filename
-                + ':'
-                + std::to_string(f_line)
-                + ": root tag cannot be an empty tag.");
+        read_from(std::make_unique<utf16_istream>(data, size));
     }
-    tok = get_token(false);
+    else
+    {
+        validate_input(false);
+    }
+}
 
-    node::pointer_t parent(root);
-    for(;;)
+
+/** \brief Create a push parser sending events to a handler.
+ *
+ * The events are sent to \p h as soon as the corresponding data was
+ * fed to the parser.
+ *
+ * \param[in] filename  The name of the file, used in error messages.
+ * \param[in] h  The handler receiving the events.
+ * \param[in] options  The options used to parse the input.
+ */
+parser::parser(
+          std::string const & filename
+        , handler & h
+        , parse_options const & options)
+    : f_filename(filename)
+    , f_handler(&h)
+    , f_options(options)
+    , f_finished(false)
+{
+    f_options.f_decode = decode_t::DECODE_NOW;
+}
+
+
+/** \brief Create a parser continuing the content of the root tag.
+ *
+ * This constructor creates a parser which parses the same buffer as
+ * \p context, starting at \p pos, as if it had just read the root start
+ * tag. The \p context parser must have read the root start tag and it
+ * must have been created from a buffer. The buffer was already validated
+ * so it does not get validated again.
+ *
+ * This is used to parse different parts of the content of the root tag
+ * in parallel.
+ *
+ * The line numbers are computed from the same starting point as in the
+ * \p context parser, so the error messages are the same as if the whole
+ * input had been parsed by one parser.
+ *
+ * \param[in] context  The parser which read the root start tag.
+ * \param[in] pos  The position where this parser starts.
+ * \param[in] h  The handler receiving the events.
+ */
+parser::parser(
+          parser const & context
+        , char const * pos
+        , handler & h)
+    : f_filename(context.f_filename)
+    , f_handler(&h)
+    , f_state(state_t::STATE_CONTENT)
+    , f_processor(true)
+    , f_offset(context.f_offset)
+    , f_begin(context.f_begin)
+    , f_pos(pos)
+    , f_valid(context.f_valid)
+    , f_end(context.f_end)
+    , f_line_ptr(context.f_line_ptr)
+    , f_line(context.f_line)
+    , f_line_cr(context.f_line_cr)
+    , f_line_chars(context.f_line_chars)
+    , f_tags(1, context.f_tags[0])
+    , f_depth(1)
+{
+    if(context.f_in != nullptr
+    || context.f_depth == 0)
+    {
+        throw logic_error("a parser can only continue the content of the root tag of a buffer.");
+    }
+}
+
+
+/** \brief Parse the whole input.
+ *
+ * This function sends all the events to the handler. It is used with
+ * the constructors which accept a handler. The other constructors
+ * already parse the input.
+ */
+void parser::parse()
+{
+    load();
+}
+
+
+/** \brief Parse the next token.
+ *
+ * This function parses one token of the input and sends the resulting
+ * events to the handler. One token may generate more than one event (for
+ * example, a start tag with attributes) or none at all (for example, the
+ * spaces before the root tag).
+ *
+ * This function cannot be used with a push parser.
+ *
+ * \return false once the end of the input was reached.
+ */
+bool parser::step()
+{
+    return next();
+}
+
+
+/** \brief Get the current position in the input.
+ *
+ * After step() returned, this is the position right after the last
+ * token.
+ *
+ * \return A pointer to the next byte to be parsed.
+ */
+char const * parser::position() const
+{
+    return f_pos;
+}
+
+
+/** \brief Get the current line number.
+ *
+ * The line number is not tracked while parsing. It gets computed from
+ * the position each time this function is called.
+ *
+ * \return The line number at position().
+ */
+int parser::line() const
+{
+    int line(0);
+    std::size_t column(0);
+    locate(f_pos, line, column);
+    return line;
+}
+
+
+/** \brief Parse the next chunk of data.
+ *
+ * This function adds \p size bytes to the input of a push parser and
+ * parses as much of it as possible. The chunk can end anywhere, including
+ * in the middle of a tag, a comment, a CDATA section, an entity, or a
+ * multibyte UTF-8 character. In that case, the last incomplete token is
+ * kept in the parser buffer and parsed again once more data arrives.
+ *
+ * To avoid parsing very large tokens over and over again, an incomplete
+ * token is retried only once the amount of data available for it doubled.
+ *
+ * \exception logic_error
+ * This exception is raised if feed() gets called after finish().
+ *
+ * \param[in] data  The bytes to parse.
+ * \param[in] size  The number of bytes in \p data.
+ */
+void parser::feed(char const * data, std::size_t size)
+{
+    append(data, size);
+    validate_input(true);
+    load();
+}
+
+
+/** \brief Parse a chain of buffers.
+ *
+ * This function is similar to feed() with a single buffer. It accepts
+ * a scatter-gather array as used by readv(2). The buffers are added to
+ * the parser input one after the other and only then parsed, so the
+ * caller does not need to concatenate them first.
+ *
+ * \param[in] chain  The array of buffers.
+ * \param[in] count  The number of buffers in \p chain.
+ */
+void parser::feed(iovec const * chain, std::size_t count)
+{
+    for(std::size_t idx(0); idx < count; ++idx)
     {
-        switch(tok)
+        append(reinterpret_cast<char const *>(chain[idx].iov_base), chain[idx].iov_len);
+    }
+    validate_input(true);
+    load();
+}
+
+
+/** \brief Tell the push parser that the whole input was fed.
+ *
+ * This function parses whatever remains in the buffer. At this point,
+ * the end of the data is the end of the file so an unclosed tag or a
+ * truncated UTF-8 character is an error.
+ *
+ * \exception unexpected_eof
+ * The data ended in the middle of a tag, comment, etc.
+ *
+ * \exception unexpected_token
+ * The root tag is missing or it was not closed.
+ */
+void parser::finish()
+{
+    if(f_finished)
+    {
+        throw logic_error("finish() called twice on the same parser.");
+    }
+    f_finished = true;
+    f_retry_size = 0;
+    validate_input(false);
+    load();
+}
+
+
+/** \brief Read the input through a decoding stream.
+ *
+ * When the input buffer is compressed or encoded in UTF-16, the parser
+ * reads it as a stream from a gzip_istream or a utf16_istream. The data
+ * gets decoded in blocks of the size of the parser input buffer so the
+ * whole document never needs to be decoded in memory.
+ *
+ * \param[in] in  The stream decoding the input buffer.
+ */
+void parser::read_from(std::unique_ptr<std::istream> in)
+{
+    f_decoder = std::move(in);
+    f_in = f_decoder.get();
+    f_buffer.resize(INPUT_BLOCK_SIZE);
+    f_begin = f_buffer.data();
+    f_pos = f_begin;
+    f_valid = f_begin;
+    f_end = f_begin;
+    f_line_ptr = f_begin;
+}
+
+
+/** \brief Add data to the push parser buffer.
+ *
+ * The bytes already parsed get removed from the buffer and the new data
+ * gets appended after the bytes of the pending token.
+ *
+ * \param[in] data  The bytes to add.
+ * \param[in] size  The number of bytes in \p data.
+ */
+void parser::append(char const * data, std::size_t size)
+{
+    if(f_finished)
+    {
+        throw logic_error("feed() called after finish().");
+    }
+
+    advance_location(f_pos);
+
+    std::size_t const consumed(f_pos - f_begin);
+    std::size_t const valid(f_valid - f_pos);
+    f_buffer.erase(f_buffer.begin(), f_buffer.begin() + consumed);
+    f_buffer.insert(f_buffer.end(), data, data + size);
+
+    f_offset += consumed;
+    f_token_start = nullptr;
+    f_begin = f_buffer.data();
+    f_line_ptr = f_begin;
+    f_pos = f_begin;
+    f_valid = f_begin + valid;
+    f_end = f_begin + f_buffer.size();
+}
+
+
+/** \brief Parse the XML and send the events to the handler.
+ *
+ * This function parses the input until the end of the file. Each
+ * element found gets sent to the handler (which, by default, builds
+ * a tree of nodes).
+ *
+ * With a push parser, the function returns as soon as the data fed so
+ * far was used up. The parser state then gets restored to the start of
+ * the incomplete token so it can be parsed again once more data arrives.
+ * The counters used to verify the limits are restored too, otherwise
+ * the token would be counted once per attempt.
+ */
+void parser::load()
+{
+    if(static_cast<std::size_t>(f_end - f_pos) < f_retry_size)
+    {
+        return;
+    }
+
+    try
+    {
+        do
+        {
+            f_checkpoint = f_pos;
+            f_checkpoint_node_count = f_node_count;
+            f_checkpoint_memory = f_memory;
+        }
+        while(next());
+        f_retry_size = 0;
+    }
+    catch(need_more_data const &)
+    {
+        f_pos = f_checkpoint;
+        f_node_count = f_checkpoint_node_count;
+        f_memory = f_checkpoint_memory;
+        f_char = nullptr;
+        f_token_start = nullptr;
+        f_retry_size = (f_end - f_pos) * 2;
+    }
+}
+
+
+/** \brief Parse the next token.
+ *
+ * This function reads one token and sends the corresponding events to
+ * the handler. A start tag is read along its attributes.
+ *
+ * The state of the parser only changes and the events are only sent
+ * once the whole token was read so the push parser can restart a token
+ * from scratch.
+ *
+ * \return false once the end of the file was reached.
+ */
+bool parser::next()
+{
+    switch(f_state)
+    {
+    case state_t::STATE_PROLOG:
         {
-        case token_t::TOK_OPEN_TAG:
+            if(f_offset == 0
+            && f_pos == f_begin)
+            {
+                skip_bom();
+            }
+
+            token_t const tok(get_token(false));
+            switch(tok)
             {
-                node::pointer_t child(std::make_shared<node>(f_value));
-                parent->append_child(child);
-                if(read_tag_attributes(child) == token_t::TOK_END_TAG)
+            case token_t::TOK_TEXT:
+                verify_empty();
+                return true;
+
+            case token_t::TOK_PROCESSOR: // allow one <?xml ... ?>
+                if(!f_processor)
                 {
-                    parent = child;
+                    f_processor = true;
+                    f_handler->processor(f_token);
+                    return true;
                 }
+                break;
+
+            case token_t::TOK_OPEN_TAG:
+                start_tag(true);
+                f_state = state_t::STATE_CONTENT;
+                return true;
+
+            default:
+                break;
+
             }
-            break;
 
-        case token_t::TOK_CLOSE_TAG:
-            if(parent->tag_name() != f_value)
+            // now we have to have the root tag
+            //
+            throw unexpected_token(
+                      location()
+                    + ": cannot be empty or include anything other than a processor tag and comments before the root tag.");
+        }
+
+    case state_t::STATE_CONTENT:
+        {
+            token_t const tok(get_token(false));
+            switch(tok)
             {
+            case token_t::TOK_OPEN_TAG:
+                start_tag(false);
+                break;
+
+            case token_t::TOK_CLOSE_TAG:
+                if(f_tags[f_depth - 1] != f_token)
+                {
+                    throw unexpected_token(
+                              location()
+                            + ": unexpected token \""
+                            + std::string(f_token)
+                            + "\" in this closing tag; expected \""
+                            + f_tags[f_depth - 1]
+                            + "\" instead.");
+                }
+                --f_depth;
+                f_handler->end_tag(f_token);
+                if(f_depth == 0)
+                {
+                    f_state = state_t::STATE_EPILOG;
+                }
+                break;
+
+            case token_t::TOK_TEXT:
+                verify_limit(f_token.length(), f_options.f_max_text_length, "text length");
+                use_memory(f_token.length());
+                f_handler->text(f_token);
+                break;
+
+            case token_t::TOK_EOF:
                 throw unexpected_token(
-                          f_filename
-                        + ':'
-                        + std::to_string(f_line)
-                        + ": unexpected token \""
-                        + f_value
-                        + "\" in this closing tag; expected \""
-                        + parent->tag_name()
-                        + "\" instead.");
+                        location()
+                      + ": reached the end of the file without first closing the root tag.");
+
+            // LCOV_EXCL_START
+            case token_t::TOK_EMPTY_TAG:
+            case token_t::TOK_END_TAG:
+            case token_t::TOK_EQUAL:
+            case token_t::TOK_IDENTIFIER:
+            case token_t::TOK_PROCESSOR:
+            case token_t::TOK_STRING:
+                throw logic_error("Received an unexpected token in the switch handler.");
+            // LCOV_EXCL_STOP
+
             }
-            parent = parent->parent();
-            if(parent == nullptr)
+        }
+        return true;
+
+    case state_t::STATE_EPILOG:
+        {
+            token_t const tok(get_token(false));
+            switch(tok)
             {
-                for(;;)
-                {
-                    tok = get_token(false);
-                    switch(tok)
-                    {
-                    case token_t::TOK_EOF:
-                        // it worked, we're done
-                        //
-                        return;
+            case token_t::TOK_EOF:
+                // it worked, we're done
+                //
+                f_state = state_t::STATE_DONE;
+                return false;
 
-                    case token_t::TOK_TEXT:
-                        tok = skip_empty(tok);
-                        break;
+            case token_t::TOK_TEXT:
+                verify_empty();
+                break;
 
-                    case token_t::TOK_PROCESSOR:
-                        // completely ignore those
-                        break;
+            case token_t::TOK_PROCESSOR:
+                f_handler->processor(f_token);
+                break;
 
-                    default:
-                        throw unexpected_token(
-                                  f_filename
-                                + ':'
-                                + std::to_string(f_line)
-                                + ": we reached the end of the XML file, but still found a token of type "
-                                + std::to_string(static_cast<int>(tok))
-                                + " after the closing root tag instead of the end of the file.");
+            default:
+                throw unexpected_token(
+                          location()
+                        + ": we reached the end of the XML file, but still found a token of type "
+                        + std::to_string(static_cast<int>(tok))
+                        + " after the closing root tag instead of the end of the file.");
 
-                    }
-                }
             }
-            break;
+        }
+        return true;
 
-        case token_t::TOK_TEXT:
-            parent->append_text(f_value);
-            break;
+    case state_t::STATE_DONE:
+        break;
 
-        case token_t::TOK_EOF:
-            throw unexpected_token(
-                    f_filename
-                  + ':'
-                  + std::to_string(f_line)
-                  + ": reached the end of the file without first closing the root tag.");
-
-        // LCOV_EXCL_START
-        case token_t::TOK_EMPTY_TAG:
-        case token_t::TOK_END_TAG:
-        case token_t::TOK_EQUAL:
-        case token_t::TOK_IDENTIFIER:
-        case token_t::TOK_PROCESSOR:
-        case token_t::TOK_STRING:
-            throw logic_error("Received an unexpected token in the switch handler.");
-        // LCOV_EXCL_STOP
+    }
 
-        }
-        tok = get_token(false);
+    return false;
+}
+
+
+/** \brief Read a start tag and send the corresponding events.
+ *
+ * The tag name is in f_token. This function reads the attributes and
+ * then sends the start_tag() and attribute() events. For an empty tag,
+ * the end_tag() event is sent immediately. Otherwise the name is saved
+ * on the stack of opened tags so the closing tag can be verified.
+ *
+ * The strings used to save the attributes and the names of the opened
+ * tags are reused from one tag to the next so once the buffers are large
+ * enough, parsing does not allocate memory anymore.
+ *
+ * \exception unexpected_token
+ * The root tag cannot be an empty tag.
+ *
+ * \param[in] root  Whether this is the root tag.
+ */
+void parser::start_tag(bool root)
+{
+    f_name.assign(f_token);
+    verify_limit(f_depth + 1, f_options.f_max_depth, "nesting depth");
+    ++f_node_count;
+    verify_limit(f_node_count, f_options.f_max_nodes, "number of nodes");
+    use_memory(sizeof(node) + f_name.length());
+
+    token_t const tok(read_tag_attributes());
+    if(root
+    && tok == token_t::TOK_EMPTY_TAG)
+    {
+        throw unexpected_token(
+                  location()
+                + ": root tag cannot be an empty tag.");
+    }
+
+    f_handler->start_tag(f_name);
+    for(std::size_t idx(0); idx < f_attribute_count; ++idx)
+    {
+        f_handler->attribute(f_attributes[idx].first, f_attributes[idx].second);
     }
+    if(tok == token_t::TOK_EMPTY_TAG)
+    {
+        f_handler->end_tag(f_name);
+        return;
+    }
+
+    if(f_depth >= f_tags.size())
+    {
+        f_tags.emplace_back();
+    }
+    f_tags[f_depth].swap(f_name);
+    ++f_depth;
 }
 
 
-parser::token_t parser::skip_empty(token_t tok)
+/** \brief Skip the UTF-8 byte order mark.
+ *
+ * A UTF-8 document may start with a byte order mark (U+FEFF). It is not
+ * part of the document so it gets skipped. The column of the first line
+ * does not count it either.
+ *
+ * The input was already validated so a 0xEF byte is always followed by
+ * two more bytes.
+ */
+void parser::skip_bom()
 {
-    while(tok == token_t::TOK_TEXT)
+    if(peekbyte() != 0xEF)
     {
-        f_value = snapdev::trim_string(f_value);
-        if(!f_value.empty())
-        {
-            throw unexpected_token(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
-                    + ": cannot include text data before or after the root tag.");
-        }
-        tok = get_token(false);
+        return;
     }
 
-    return tok;
+    char32_t const c(get_opaque());
+    if(static_cast<unsigned char>(f_char[1]) != 0xBB
+    || static_cast<unsigned char>(f_char[2]) != 0xBF)
+    {
+        ungetc(c);
+        return;
+    }
+    f_char = nullptr;
+    advance_location(f_pos);
+    f_line_chars = 0;
 }
 
 
-parser::token_t parser::read_tag_attributes(node::pointer_t & tag)
+/** \brief Verify that text outside of the root tag is only spaces.
+ *
+ * \exception unexpected_token
+ * The text includes characters other than spaces.
+ */
+void parser::verify_empty()
 {
+    if(f_token.find_first_not_of(" \t\n\r\v\f") != std::string_view::npos)
+    {
+        throw unexpected_token(
+                  location()
+                + ": cannot include text data before or after the root tag.");
+    }
+}
+
+
+/** \brief Read the attributes of a tag.
+ *
+ * This function reads the attributes up to the end of the tag. They get
+ * saved in f_attributes.
+ *
+ * \exception invalid_xml
+ * The attributes are not valid or one is defined twice.
+ *
+ * \return TOK_END_TAG or TOK_EMPTY_TAG depending on how the tag ended.
+ */
+parser::token_t parser::read_tag_attributes()
+{
+    f_attribute_count = 0;
     for(;;)
     {
         token_t tok(get_token(true));
@@ -228,39 +850,43 @@ parser::token_t parser::read_tag_attributes(node::pointer_t & tag)
         if(tok != token_t::TOK_IDENTIFIER)
         {
             throw invalid_xml(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
+                      location()
                     + ": expected the end of the tag (>) or an attribute name.");
         }
-        std::string const name(f_value);
+        verify_limit(f_attribute_count + 1, f_options.f_max_attributes, "number of attributes");
+        if(f_attribute_count >= f_attributes.size())
+        {
+            f_attributes.emplace_back();
+        }
+        auto & a(f_attributes[f_attribute_count]);
+        a.first.assign(f_token);
         tok = get_token(true);
         if(tok != token_t::TOK_EQUAL)
         {
             throw invalid_xml(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
+                      location()
                     + ": expected the '=' character between the attribute name and value.");
         }
         tok = get_token(true);
         if(tok != token_t::TOK_STRING)
         {
             throw invalid_xml(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
+                      location()
                     + ": expected a quoted value after the '=' sign.");
         }
-        if(!tag->attribute(name).empty())
+        for(std::size_t idx(0); idx < f_attribute_count; ++idx)
         {
-            throw invalid_xml(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
-                    + ": attribute \"" + name + "\" defined twice; we do not allow such.");
+            if(f_attributes[idx].first == a.first)
+            {
+                throw invalid_xml(
+                          location()
+                        + ": attribute \"" + a.first + "\" defined twice; we do not allow such.");
+            }
         }
-        tag->set_attribute(name, f_value);
+        verify_limit(f_token.length(), f_options.f_max_attribute_length, "attribute length");
+        use_memory(ATTRIBUTE_OVERHEAD + a.first.length() + f_token.length());
+        a.second.assign(f_token);
+        ++f_attribute_count;
     }
     snapdev::NOT_REACHED();
 }
@@ -269,6 +895,8 @@ parser::token_t parser::read_tag_attributes(node::pointer_t & tag)
 parser::token_t parser::get_token(bool parsing_attributes)
 {
     f_value.clear();
+    f_token = std::string_view();
+    f_token_start = nullptr;
 
     for(;;)
     {
@@ -299,25 +927,30 @@ parser::token_t parser::get_token(bool parsing_attributes)
                 //
                 for(;;)
                 {
-                    c = getc();
+                    // copy plain characters in one go
+                    //
+                    char const * const special(find_section_special(f_pos, f_valid, '?'));
+                    f_value.append(f_pos, special);
+                    f_pos = special;
+
+                    c = get_opaque();
                     if(c == static_cast<char32_t>(EOF))
                     {
                         throw unexpected_eof(
-                              f_filename
-                            + ':'
-                            + std::to_string(f_line)
+                              location()
                             + ": reached the end of the file while reading a processor (\"<?...?>\") tag.");
                     }
                     while(c == '?')
                     {
-                        c = getc();
+                        c = get_opaque();
                         if(c == '>')
                         {
+                            f_token = f_value;
                             return token_t::TOK_PROCESSOR;
                         }
                         f_value += '?';
                     }
-                    f_value += libutf8::to_u8string(c);
+                    append_char(c);
                 }
                 snapdev::NOT_REACHED();
                 return token_t::TOK_PROCESSOR;
@@ -330,9 +963,7 @@ parser::token_t parser::get_token(bool parsing_attributes)
                     // of course, this may be anything other than an element but still something we don't support
                     //
                     throw invalid_xml(
-                          f_filename
-                        + ':'
-                        + std::to_string(f_line)
+                          location()
                         + ": found an element definition (such as an \"<!ELEMENT...>\" sequence), which is not supported.");
                 }
                 if(c == '[')
@@ -345,53 +976,63 @@ parser::token_t parser::get_token(bool parsing_attributes)
                         if(getc() != expected[j])
                         {
                             throw invalid_xml(
-                                  f_filename
-                                + ':'
-                                + std::to_string(f_line)
+                                  location()
                                 + ": found an unexpected sequence of character in a \"<![CDATA[...\" sequence.");
                         }
                     }
                     for(;;)
                     {
-                        c = getc();
+                        // copy plain characters in one go
+                        //
+                        char const * const special(find_section_special(f_pos, f_valid, ']'));
+                        f_value.append(f_pos, special);
+                        f_pos = special;
+
+                        c = get_opaque();
                         if(c == static_cast<char32_t>(EOF))
                         {
                             throw unexpected_eof(
-                                  f_filename
-                                + ':'
-                                + std::to_string(f_line)
+                                  location()
                                 + ": found EOF while parsing a \"<![CDATA[...]]>\" sequence.");
                         }
                         if(c == ']')
                         {
-                            c = getc();
+                            c = get_opaque();
                             if(c == ']')
                             {
-                                c = getc();
+                                c = get_opaque();
                                 while(c == ']')
                                 {
                                     f_value += ']';
-                                    c = getc();
+                                    c = get_opaque();
                                 }
                                 if(c == '>')
                                 {
                                     // this is just like some text
                                     // except we do not convert entities
                                     //
+                                    if(f_options.f_decode == decode_t::DECODE_LAZY)
+                                    {
+                                        // the node will decode the text
+                                        // later so protect the '&'
+                                        //
+                                        f_value = snapdev::string_replace_many(f_value, {{"&", "&amp;"}});
+                                    }
+                                    f_token = f_value;
                                     return token_t::TOK_TEXT;
                                 }
                                 f_value += "]]";
-                                f_value += libutf8::to_u8string(c);
+                                append_char(c);
                             }
                             else
                             {
                                 f_value += ']';
-                                f_value += libutf8::to_u8string(c);
+                                append_char(c);
                             }
                         }
                         else
                         {
-                            f_value += libutf8::to_u8string(c);
+                            append_char(c);
                         }
                     }
                 }
@@ -406,21 +1047,23 @@ parser::token_t parser::get_token(bool parsing_attributes)
                         bool found(false);
                         while(!found)
                         {
-                            c = getc();
+                            // skip plain characters in one go
+                            //
+                            f_pos = find_section_special(f_pos, f_valid, '-');
+
+                            c = get_opaque();
                             if(c == static_cast<char32_t>(EOF))
                             {
                                 throw unexpected_eof(
-                                      f_filename
-                                    + ':'
-                                    + std::to_string(f_line)
+                                      location()
                                     + ": found EOF while parsing a comment (\"<!--...-->\") sequence.");
                             }
                             if(c == '-')
                             {
-                                c = getc();
+                                c = get_opaque();
                                 while(c == '-')
                                 {
-                                    c = getc();
+                                    c = get_opaque();
                                     if(c == '>')
                                     {
                                         found = true;
@@ -433,9 +1076,7 @@ parser::token_t parser::get_token(bool parsing_attributes)
                     }
                 }
                 throw invalid_token(
-                          f_filename
-                        + ':'
-                        + std::to_string(f_line)
+                          location()
                         + std::string(": character '")
                         + libutf8::to_u8string(c)
                         + "' was not expected after a \"<!\" sequence.");
@@ -451,28 +1092,17 @@ parser::token_t parser::get_token(bool parsing_attributes)
                     if(c == static_cast<char32_t>(EOF))
                     {
                         throw unexpected_eof(
-                              f_filename
-                            + ':'
-                            + std::to_string(f_line)
+                              location()
                             + ": expected a tag name after \"</\", not EOF.");
                     }
                     throw invalid_token(
-                              f_filename
-                            + ':'
-                            + std::to_string(f_line)
+                              location()
                             + ": character '"
                             + libutf8::to_u8string(c)
                             + "' is not valid for a tag name.");
                 }
-                for(;;)
-                {
-                    f_value += libutf8::to_u8string(c);
-                    c = getc();
-                    if(!is_name_char(c))
-                    {
-                        break;
-                    }
-                }
+                std::size_t const length(read_name());
+                c = getc();
                 while(is_space(c))
                 {
                     c = getc();
@@ -482,19 +1112,16 @@ parser::token_t parser::get_token(bool parsing_attributes)
                     if(c == static_cast<char32_t>(EOF))
                     {
                         throw unexpected_eof(
-                              f_filename
-                            + ':'
-                            + std::to_string(f_line)
+                              location()
                             + ": expected '>', not EOF.");
                     }
                     throw invalid_xml(
-                              f_filename
-                            + ':'
-                            + std::to_string(f_line)
+                              location()
                             + ": found an unexpected '"
                             + static_cast<char>(c)
                             + "' in a closing tag, expected '>' instead.");
                 }
+                f_token = std::string_view(f_token_start, length);
                 return token_t::TOK_CLOSE_TAG;
 
             }
@@ -511,28 +1138,17 @@ parser::token_t parser::get_token(bool parsing_attributes)
                 if(c == static_cast<char32_t>(EOF))
                 {
                     throw unexpected_eof(
-                          f_filename
-                        + ':'
-                        + std::to_string(f_line)
+                          location()
                         + ": expected a tag name after '<', not EOF.");
                 }
                 throw invalid_token(
-                          f_filename
-                        + ':'
-                        + std::to_string(f_line)
+                          location()
                         + ": character '"
                         + libutf8::to_u8string(c)
                         + "' is not valid for a tag name.");
             }
-            for(;;)
-            {
-                f_value += libutf8::to_u8string(c);
-                c = getc();
-                if(!is_name_char(c))
-                {
-                    break;
-                }
-            }
+            f_token = std::string_view(f_token_start, read_name());
+            c = getc();
             if(isspace(c))
             {
                 do
@@ -544,14 +1160,16 @@ parser::token_t parser::get_token(bool parsing_attributes)
             else if(c != '>' && c != '/')
             {
                 throw invalid_token(
-                          f_filename
-                        + ':'
-                        + std::to_string(f_line)
+                          location()
                         + ": character '"
                         + libutf8::to_u8string(c)
                         + "' is not valid right after a tag name.");
             }
             ungetc(c);
+
+            // the buffer may have moved while reading the spaces
+            //
+            f_token = std::string_view(f_token_start, f_token.length());
             return token_t::TOK_OPEN_TAG;
 
         case '>':
@@ -570,7 +1188,7 @@ parser::token_t parser::get_token(bool parsing_attributes)
                     return token_t::TOK_EMPTY_TAG;
                 }
                 ungetc(c);
-                c = '/';
+                return token_t::TOK_TEXT;
             }
             break;
 
@@ -586,23 +1204,33 @@ parser::token_t parser::get_token(bool parsing_attributes)
             if(parsing_attributes)
             {
                 auto quote(c);
+                start_token(f_pos);
                 for(;;)
                 {
-                    c = getc();
+                    // skip plain characters in one go
+                    //
+                    skip_to(find_value_special(f_pos, f_valid, static_cast<char>(quote)));
+
+                    c = get_opaque();
                     if(c == quote)
                     {
+                        end_token(f_char);
                         unescape_entities();
                         return token_t::TOK_STRING;
                     }
                     if(c == '>')
                     {
                         throw invalid_token(
-                              f_filename
-                            + ':'
-                            + std::to_string(f_line)
+                              location()
                             + ": character '>' not expected inside a tag value; please use \"&gt;\" instead.");
                     }
-                    f_value += libutf8::to_u8string(c);
+                    if(c == static_cast<decltype(c)>(EOF))
+                    {
+                        throw unexpected_eof(
+                              location()
+                            + ": reached the end of the file while reading an attribute value.");
+                    }
+                    token_char(c);
                 }
                 snapdev::NOT_REACHED();
             }
@@ -610,30 +1238,35 @@ parser::token_t parser::get_token(bool parsing_attributes)
 
         }
 
-        if(parsing_attributes
-        && is_name_char(c))
+        if(parsing_attributes)
         {
-            for(;;)
+            if(is_name_char(c))
             {
-                f_value += libutf8::to_u8string(c);
-                c = getc();
-                if(!is_name_char(c))
-                {
-                    ungetc(c);
-                    return token_t::TOK_IDENTIFIER;
-                }
+                std::size_t const length(read_name());
+                f_token = std::string_view(f_token_start, length);
+                return token_t::TOK_IDENTIFIER;
             }
-            snapdev::NOT_REACHED();
+
+            // text is not valid inside a tag, the caller reports the error
+            //
+            return token_t::TOK_TEXT;
         }
 
+        start_token(f_char);
         for(;;)
         {
-            f_value += libutf8::to_u8string(c);
-            c = getc();
+            token_char(c);
+
+            // skip plain characters in one go
+            //
+            skip_to(find_text_special(f_pos, f_valid));
+
+            c = get_opaque();
             if(c == '<'
             || c == static_cast<decltype(c)>(EOF))
             {
                 ungetc(c);
+                end_token(f_pos);
                 unescape_entities();
                 return token_t::TOK_TEXT;
             }
@@ -642,187 +1275,550 @@ parser::token_t parser::get_token(bool parsing_attributes)
 }
 
 
-void parser::unescape_entities()
+/** \brief Read the rest of a name.
+ *
+ * This function is called once getc() returned the first character of
+ * a name. It reads the following name characters and leaves the cursor
+ * right after the name. The ASCII characters are checked directly in the
+ * buffer; only the multi-byte characters go through getc().
+ *
+ * The name is not copied. It starts at f_token_start and the function
+ * returns its length. Note that f_token_start gets updated whenever
+ * refill() moves the data in the buffer.
+ *
+ * \return The length of the name in bytes.
+ */
+std::size_t parser::read_name()
 {
-    for(std::string::size_type pos(0);;)
+    f_token_start = f_char;
+    for(;;)
     {
-        pos = f_value.find('&', pos);
-        if(pos == std::string::npos)
-        {
-            break;
-        }
-        std::string::size_type const end(f_value.find(';', pos + 1));
-        if(end == std::string::npos)
-        {
-            // generate an error here?
-            //
-            break;
-        }
-        std::string name(f_value.substr(pos + 1, end - pos - 1));
-        if(name == "amp")
-        {
-            f_value.replace(pos, end - pos + 1, 1, '&');
-            ++pos;
-        }
-        else if(name == "quot")
+        while(f_pos < f_valid
+           && static_cast<unsigned char>(*f_pos) < 0x80
+           && is_name_char(static_cast<unsigned char>(*f_pos)))
         {
-            f_value.replace(pos, end - pos + 1, 1, '"');
-            ++pos;
+            ++f_pos;
         }
-        else if(name == "lt")
+        char32_t const c(getc());
+        if(!is_name_char(c))
         {
-            f_value.replace(pos, end - pos + 1, 1, '<');
-            ++pos;
-        }
-        else if(name == "gt")
-        {
-            f_value.replace(pos, end - pos + 1, 1, '>');
-            ++pos;
-        }
-        else if(name == "apos")
-        {
-            f_value.replace(pos, end - pos + 1, 1, '\'');
-            ++pos;
+            ungetc(c);
+            return f_pos - f_token_start;
         }
-        else if(name.empty())
+    }
+}
+
+
+/** \brief Start reading a text or a value token.
+ *
+ * The token is a view of the input starting at \p start. The refill()
+ * function keeps the bytes of the token in the buffer until it gets
+ * returned.
+ *
+ * \param[in] start  The first byte of the token.
+ */
+void parser::start_token(char const * start)
+{
+    f_token_start = start;
+    f_copy = false;
+}
+
+
+/** \brief Add the character just read by get_opaque() to the token.
+ *
+ * The token remains a view of the input as long as its bytes do not
+ * change. A "\r" or "\r\n" sequence gets converted to a "\n", so the
+ * first time one is found, the token gets copied in f_value and from
+ * then on the characters are appended to f_value.
+ *
+ * \param[in] c  The character returned by get_opaque() or getc().
+ */
+void parser::token_char(char32_t c)
+{
+    if(!f_copy
+    && c == '\n'
+    && *f_char == '\r')
+    {
+        f_value.assign(f_token_start, f_char - f_token_start);
+        f_copy = true;
+    }
+    if(f_copy)
+    {
+        append_char(c);
+    }
+}
+
+
+/** \brief Move the cursor to \p end.
+ *
+ * The plain characters between the cursor and \p end are part of the
+ * token. They only need to be copied once the token is in f_value.
+ *
+ * \param[in] end  The new position of the cursor.
+ */
+void parser::skip_to(char const * end)
+{
+    if(f_copy)
+    {
+        f_value.append(f_pos, end);
+    }
+    f_pos = end;
+}
+
+
+/** \brief Terminate the current text or value token.
+ *
+ * \param[in] end  The byte right after the token.
+ */
+void parser::end_token(char const * end)
+{
+    if(f_copy)
+    {
+        f_token = f_value;
+    }
+    else
+    {
+        f_token = std::string_view(f_token_start, end - f_token_start);
+    }
+}
+
+
+/** \brief Append the character just read by get_opaque() to f_value.
+ *
+ * The bytes are copied as is from the input, except for a '\n' which
+ * may have been converted from a "\r" or "\r\n" sequence.
+ *
+ * \param[in] c  The character returned by get_opaque() or getc().
+ */
+void parser::append_char(char32_t c)
+{
+    if(c == '\n')
+    {
+        f_value += '\n';
+    }
+    else
+    {
+        f_value.append(f_char, f_pos - f_char);
+    }
+}
+
+
+/** \brief Convert the entities found in f_token.
+ *
+ * This function replaces the entities found in f_token with the
+ * corresponding characters. The location used in error messages is
+ * only computed when the value includes at least one '&'.
+ *
+ * Since the token may be a view of the input, it first gets copied
+ * in f_value, which then receives the decoded characters.
+ *
+ * In lazy mode, the entities are left alone. The nodes decode them
+ * on the first access.
+ *
+ * \exception invalid_entity
+ * An entity is not valid.
+ *
+ * \exception invalid_number
+ * A numeric entity does not represent a valid Unicode character.
+ */
+void parser::unescape_entities()
+{
+    if(f_options.f_decode == decode_t::DECODE_LAZY
+    || memchr(f_token.data(), '&', f_token.length()) == nullptr)
+    {
+        return;
+    }
+    if(f_token.data() != f_value.data())
+    {
+        f_value.assign(f_token);
+    }
+    f_value.resize(basic_xml::unescape_entities(
+              f_value.data()
+            , f_value.length()
+            , [this]() { return location(); }));
+    f_token = f_value;
+}
+
+
+/** \brief Compute the line and column of a position.
+ *
+ * The parser does not count the lines while reading the input. Instead,
+ * the line and column get computed from the position, which is only
+ * needed in error messages. The count starts at f_line_ptr, which is
+ * the start of the buffer unless the input is read in blocks, in which
+ * case it moves along with the data dropped by refill().
+ *
+ * The column is the number of characters from the start of the line,
+ * plus one.
+ *
+ * \param[in] p  The position to locate, at or after f_line_ptr.
+ * \param[out] line  The line number at \p p.
+ * \param[out] column  The column at \p p.
+ */
+void parser::locate(char const * p, int & line, std::size_t & column) const
+{
+    bool cr(f_line_cr);
+    line = f_line + static_cast<int>(count_lines(f_line_ptr, p, cr));
+
+    char const * s(p);
+    while(s > f_line_ptr
+       && s[-1] != '\n'
+       && s[-1] != '\r')
+    {
+        --s;
+    }
+    column = s == f_line_ptr ? f_line_chars : 0;
+    for(; s < p; ++s)
+    {
+        // count the UTF-8 lead bytes only
+        //
+        if((*s & 0xC0) != 0x80)
         {
-            throw invalid_entity(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
-                    + ": the name of an entity cannot be empty (\"&;\" is not valid XML).");
+            ++column;
         }
-        else if(name[0] == '#')
+    }
+    ++column;
+}
+
+
+/** \brief Move the start of the line count to \p to.
+ *
+ * This function is called before the data up to \p to gets dropped
+ * from the buffer. The caller then sets f_line_ptr to the new position
+ * of \p to in the buffer.
+ *
+ * \param[in] to  The new start of the line count.
+ */
+void parser::advance_location(char const * to)
+{
+    std::size_t column(0);
+    locate(to, f_line, column);
+    f_line_chars = column - 1;
+    if(to > f_line_ptr)
+    {
+        f_line_cr = to[-1] == '\r';
+    }
+    f_line_ptr = to;
+}
+
+
+/** \brief Get the location of the current position for error messages.
+ *
+ * \return The filename, line, and column separated by colons.
+ */
+std::string parser::location() const
+{
+    int line(0);
+    std::size_t column(0);
+    locate(f_pos, line, column);
+    return f_filename
+         + ':'
+         + std::to_string(line)
+         + ':'
+         + std::to_string(column);
+}
+
+
+/** \brief Verify one of the parse limits.
+ *
+ * A limit of 0 means that there is no limit.
+ *
+ * \exception limit_exceeded
+ * The \p value is larger than \p limit.
+ *
+ * \param[in] value  The value to verify.
+ * \param[in] limit  The limit as defined in the parse options.
+ * \param[in] name  The name of the limit used in the error message.
+ */
+void parser::verify_limit(std::size_t value, std::size_t limit, char const * name)
+{
+    if(limit != 0
+    && value > limit)
+    {
+        throw limit_exceeded(
+                  location()
+                + ": "
+                + name
+                + " ("
+                + std::to_string(value)
+                + ") is over the limit of "
+                + std::to_string(limit)
+                + '.');
+    }
+}
+
+
+/** \brief Add \p size bytes to the estimated memory usage.
+ *
+ * The memory usage is an estimate of the memory needed to hold the
+ * parsed data: the input buffer of the parser, the nodes with their
+ * names, attributes and text. It does not include the memory used
+ * by the handler for its own purpose.
+ *
+ * \exception limit_exceeded
+ * The memory usage is over the f_max_memory limit.
+ *
+ * \param[in] size  The number of bytes to add.
+ */
+void parser::use_memory(std::size_t size)
+{
+    f_memory += size;
+    verify_limit(f_memory + f_buffer.capacity(), f_options.f_max_memory, "memory usage");
+}
+
+
+/** \brief Validate the UTF-8 of the input.
+ *
+ * The input is validated in bulk as it gets loaded, before the
+ * tokenizer reads it. The bytes before f_valid are known to be valid.
+ *
+ * When \p more is true, the input may end with an incomplete UTF-8
+ * sequence. Those bytes are validated again on the next refill().
+ *
+ * Since all the input goes through this function, it also verifies
+ * the size and memory limits.
+ *
+ * \exception limit_exceeded
+ * The input is larger than the f_max_size or f_max_memory limits.
+ *
+ * \exception invalid_utf8
+ * The input includes an invalid UTF-8 sequence.
+ *
+ * \param[in] more  Whether more data may follow f_end.
+ */
+void parser::validate_input(bool more)
+{
+    verify_limit(f_offset + (f_end - f_begin), f_options.f_max_size, "input size");
+    use_memory(0);
+
+    bool truncated(false);
+    char const * const invalid(find_invalid_utf8(f_valid, f_end, truncated));
+    if(invalid != f_end
+    && (!truncated || !more))
+    {
+        if(f_offset == 0
+        && invalid == f_begin
+        && is_utf16(f_begin, f_end - f_begin))
         {
-            if(name.length() == 1)
-            {
-                throw invalid_entity(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
-                    + ": a numeric entity must have a number (\"&#;\" is not valid XML).");
-            }
-            int base(10);
-            if(name[1] == 'x'
-            || name[1] == 'X')
-            {
-                name[0] = '0';
-                base = 16;
-            }
-            else
-            {
-                name[0] = ' ';
-            }
-            errno = 0;
-            char * e(nullptr);
-            char32_t const unicode(strtol(name.c_str(), &e, base));
-            if(errno != 0
-            || e == nullptr
-            || *e != '\0')
-            {
-                throw invalid_number(
+            throw invalid_utf8(
                       f_filename
-                    + ':'
-                    + std::to_string(f_line)
-                    + ": the number found in numeric entity, \""
-                    + name
-                    + "\", is not considered valid.");
-            }
-            std::string const utf8(libutf8::to_u8string(unicode));
-            f_value.replace(pos, end - pos + 1, utf8);
-            pos += utf8.length();
+                    + ": the input is UTF-16, read it through a utf16_istream.");
         }
-        else
+        throw invalid_utf8(
+                  f_filename
+                + ": invalid UTF-8 sequence found at byte offset "
+                + std::to_string(f_offset + (invalid - f_begin))
+                + '.');
+    }
+    f_valid = invalid;
+}
+
+
+/** \brief Read more data from the input stream.
+ *
+ * When the parser reads from an std::istream, the data is read in large
+ * blocks using the stream buffer sgetn() function instead of one
+ * character at a time.
+ *
+ * The bytes of the character currently being read (i.e. starting at
+ * f_char) are moved at the start of the buffer so that a UTF-8 sequence
+ * can span two blocks and ungetc() can still rewind the cursor. While a
+ * token is being read, the bytes from f_token_start are kept instead so
+ * the token can be returned as a view of the buffer. The buffer grows
+ * when a token uses more than half of it.
+ *
+ * The new data gets validated with validate_input().
+ *
+ * A push parser has no stream. If finish() was not called yet, it
+ * raises need_more_data so load() can wait for the next feed().
+ *
+ * \return true if more bytes are available.
+ */
+bool parser::refill()
+{
+    if(f_in == nullptr)
+    {
+        if(!f_finished)
         {
-            throw invalid_entity(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
-                    + ": unsupported entity (\"&"
-                    + name
-                    + ";\").");
+            // the push parser needs to wait for more data
+            //
+            throw need_more_data();
         }
+        return false;
+    }
+
+    char const * const start(f_token_start != nullptr
+                                ? f_token_start
+                                : (f_char == nullptr ? f_pos : f_char));
+    std::size_t const keep(f_end - start);
+    f_offset += start - f_begin;
+    advance_location(start);
+    if(keep > f_buffer.size() / 2)
+    {
+        std::vector<char> larger(f_buffer.size() * 2);
+        std::memcpy(larger.data(), start, keep);
+        f_buffer.swap(larger);
+    }
+    else if(keep > 0)
+    {
+        std::memmove(f_buffer.data(), start, keep);
+    }
+    char * const buffer(f_buffer.data());
+
+    std::streamsize const size(f_in->rdbuf()->sgetn(
+                      buffer + keep
+                    , f_buffer.size() - keep));
+
+    f_begin = buffer;
+    f_line_ptr = buffer;
+    f_pos = buffer + (f_pos - start);
+    f_valid = buffer + (f_valid - start);
+    if(f_char != nullptr)
+    {
+        f_char = buffer + (f_char - start);
+    }
+    if(f_token_start != nullptr)
+    {
+        f_token_start = buffer;
+    }
+    f_end = buffer + keep + std::max(size, static_cast<std::streamsize>(0));
+
+    validate_input(size > 0);
+
+    return size > 0;
+}
+
+
+int parser::peekbyte()
+{
+    if(f_pos >= f_end
+    && !refill())
+    {
+        return EOF;
     }
+    return static_cast<unsigned char>(*f_pos);
 }
 
 
-char32_t parser::getc()
+int parser::getbyte()
 {
-    if(f_ungetc_pos > 0)
+    int const c(peekbyte());
+    if(c != EOF)
     {
-        --f_ungetc_pos;
-        return f_ungetc[f_ungetc_pos];
+        ++f_pos;
     }
+    return c;
+}
 
-    int c(f_in.get());
-    if(c == '\r')
+
+/** \brief Read the next character without decoding it.
+ *
+ * Most of the input is ASCII and most of the time the parser only needs
+ * to know where a character starts and ends, not its code point. This
+ * function returns ASCII characters directly from the buffer. For a
+ * multibyte character, it skips the whole UTF-8 sequence and returns
+ * its lead byte, which is always 0xC2 or more, so it can't be mistaken
+ * for one of the ASCII characters the parser looks for. The bytes of the
+ * character are found between f_char and f_pos.
+ *
+ * A "\r" or "\r\n" sequence is returned as a '\n'.
+ *
+ * \return The next character, the lead byte of a multibyte character,
+ * or EOF.
+ */
+char32_t parser::get_opaque()
+{
+    f_char = f_pos;
+
+    if(f_pos < f_end)
     {
-        ++f_line;
-        c = f_in.get();
-        if(c != '\n')
+        // fast path for the usual ASCII characters
+        //
+        unsigned char const b(*f_pos);
+        if(b < 0x80
+        && b != '\r'
+        && b != '\n')
         {
-            ungetc(c);
-            c = '\n';
+            ++f_pos;
+            return b;
         }
     }
-    else if(c == '\n')
+
+    int c(getbyte());
+    if(c == '\r')
     {
-        ++f_line;
+        if(peekbyte() == '\n')
+        {
+            ++f_pos;
+        }
+        c = '\n';
     }
-
-    if(c >= 0x80)
+    else if(c >= 0x80)
     {
-        // define the number of bytes required (assuming valid UTF-8)
+        // the input was already validated so the continuation bytes
+        // do not need to be checked
         //
-        std::size_t const count(c < 0xE0 ? 2UL : (c < 0xF0 ? 3UL : 4UL));
-        char input[5];
-        input[0] = c;
-        std::size_t len(1);
-        for(; len < count; ++len)
+        std::size_t const length(c < 0xE0 ? 2 : (c < 0xF0 ? 3 : 4));
+        for(std::size_t idx(1); idx < length; ++idx)
         {
-            c = f_in.get();
-            if(c < 0x80 || c >= 0xC0)
-            {
-                // not valid, at least don't eat the next byte improperly
-                //
-                ungetc(c);
-                break;
-            }
-            input[len] += c;
+            getbyte();
         }
-        input[len] = '\0';
-        char32_t result(U'\0');
-        char * s(input);
-        if(libutf8::mbstowc(result, s, len) == -1)
+    }
+
+    return c;
+}
+
+
+/** \brief Read the next character.
+ *
+ * This function reads the next character with get_opaque() and decodes
+ * the UTF-8 sequence of multibyte characters. It is used where the code
+ * point matters, such as to validate the characters of a name.
+ *
+ * \return The next character or EOF.
+ */
+char32_t parser::getc()
+{
+    char32_t const c(get_opaque());
+    if(c >= 0x80
+    && c != static_cast<char32_t>(EOF))
+    {
+        unsigned char const * s(reinterpret_cast<unsigned char const *>(f_char));
+        std::size_t const length(f_pos - f_char);
+        char32_t result(s[0] & (0x7F >> length));
+        for(std::size_t idx(1); idx < length; ++idx)
         {
-            return U'\xFFFD';
+            result = (result << 6) | (s[idx] & 0x3F);
         }
         return result;
     }
-    else
-    {
-        return c;
-    }
+
+    return c;
 }
 
 
+/** \brief Push the last character back.
+ *
+ * This function rewinds the input cursor to the start of the last
+ * character returned by getc(). Only one character can be pushed back.
+ *
+ * \param[in] c  The character being pushed back.
+ */
 void parser::ungetc(char32_t c)
 {
     if(c != static_cast<char32_t>(EOF))
     {
-        if(f_ungetc_pos >= std::size(f_ungetc))
+        if(f_char == nullptr)
         {
             // LCOV_EXCL_START
             throw logic_error(
-                      f_filename
-                    + ':'
-                    + std::to_string(f_line)
-                    + ": somehow the f_ungetc buffer was overflowed.");
+                      location()
+                    + ": somehow ungetc() was called twice in a row.");
             // LCOV_EXCL_STOP
         }
 
-        f_ungetc[f_ungetc_pos] = c;
-        ++f_ungetc_pos;
+        f_pos = f_char;
+        f_char = nullptr;
     }
 }
 
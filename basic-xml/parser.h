@@ -26,12 +26,23 @@
 
 // self
 //
+#include    <basic-xml/gzip.h>
+#include    <basic-xml/handler.h>
 #include    <basic-xml/node.h>
+#include    <basic-xml/parse_options.h>
 
 
 // C++
 //
 #include    <istream>
+#include    <memory>
+#include    <string_view>
+#include    <vector>
+
+
+// C
+//
+#include    <sys/uio.h>
 
 
 
@@ -43,7 +54,21 @@ namespace basic_xml
 class parser
 {
 public:
-                        parser(std::string const & filename, std::istream & in, node::pointer_t & root);
+                        parser(std::string const & filename, std::istream & in, node::pointer_t & root, parse_options const & options = parse_options());
+                        parser(std::string const & filename, char const * data, std::size_t size, node::pointer_t & root, parse_options const & options = parse_options());
+                        parser(std::string const & filename, node::pointer_t & root, parse_options const & options = parse_options());
+                        parser(std::string const & filename, std::istream & in, handler & h, parse_options const & options = parse_options());
+                        parser(std::string const & filename, char const * data, std::size_t size, handler & h, parse_options const & options = parse_options());
+                        parser(std::string const & filename, handler & h, parse_options const & options = parse_options());
+                        parser(parser const & context, char const * pos, handler & h);
+
+    void                parse();
+    bool                step();
+    char const *        position() const;
+    int                 line() const;
+    void                feed(char const * data, std::size_t size);
+    void                feed(iovec const * chain, std::size_t count);
+    void                finish();
 
 private:
     enum class token_t
@@ -60,20 +85,87 @@ private:
         TOK_TEXT
     };
 
-    void                load(node::pointer_t & root);
-    token_t             skip_empty(token_t tok);
-    token_t             read_tag_attributes(node::pointer_t & tag);
+    enum class state_t
+    {
+        STATE_PROLOG,
+        STATE_CONTENT,
+        STATE_EPILOG,
+        STATE_DONE
+    };
+
+    // thrown when a push parser reaches the end of the data fed so far
+    class need_more_data
+    {
+    };
+
+    void                append(char const * data, std::size_t size);
+    void                read_from(std::unique_ptr<std::istream> in);
+    void                load();
+    bool                next();
+    void                verify_empty();
+    void                skip_bom();
+    void                start_tag(bool root);
+    token_t             read_tag_attributes();
     token_t             get_token(bool parsing_attributes);
+    std::size_t         read_name();
+    void                start_token(char const * start);
+    void                token_char(char32_t c);
+    void                skip_to(char const * end);
+    void                end_token(char const * end);
+    void                append_char(char32_t c);
     void                unescape_entities();
+    void                locate(char const * p, int & line, std::size_t & column) const;
+    void                advance_location(char const * to);
+    std::string         location() const;
+    void                verify_limit(std::size_t value, std::size_t limit, char const * name);
+    void                use_memory(std::size_t size);
+    void                validate_input(bool more);
+    bool                refill();
+    int                 peekbyte();
+    int                 getbyte();
+    char32_t            get_opaque();
     char32_t            getc();
     void                ungetc(char32_t c);
 
     std::string         f_filename = std::string();
-    std::istream &      f_in;
-    std::size_t         f_ungetc_pos = 0;
-    char32_t            f_ungetc[4] = { '\0' };
+    std::unique_ptr<handler>
+                        f_builder = std::unique_ptr<handler>();
+    handler *           f_handler = nullptr;
+    state_t             f_state = state_t::STATE_PROLOG;
+    bool                f_processor = false;
+    parse_options       f_options = parse_options();
+    std::size_t         f_node_count = 0;
+    std::size_t         f_memory = 0;
+    bool                f_finished = true;
+    std::unique_ptr<std::istream>
+                        f_decoder = std::unique_ptr<std::istream>();
+    std::istream *      f_in = nullptr;
+    std::vector<char>   f_buffer = std::vector<char>();
+    std::size_t         f_offset = 0;
+    char const *        f_begin = nullptr;
+    char const *        f_pos = nullptr;
+    char const *        f_valid = nullptr;
+    char const *        f_end = nullptr;
+    char const *        f_char = nullptr;
+    char const *        f_line_ptr = nullptr;
     int                 f_line = 1;
+    bool                f_line_cr = false;
+    std::size_t         f_line_chars = 0;
+    char const *        f_checkpoint = nullptr;
+    std::size_t         f_checkpoint_node_count = 0;
+    std::size_t         f_checkpoint_memory = 0;
+    std::size_t         f_retry_size = 0;
     std::string         f_value = std::string();
+    std::string_view    f_token = std::string_view();
+    char const *        f_token_start = nullptr;
+    bool                f_copy = false;
+    std::string         f_name = std::string();
+    std::vector<std::pair<std::string, std::string>>
+                        f_attributes = std::vector<std::pair<std::string, std::string>>();
+    std::size_t         f_attribute_count = 0;
+    std::vector<std::string>
+                        f_tags = std::vector<std::string>();
+    std::size_t         f_depth = 0;
 };
 
 
@@ -0,0 +1,168 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the push parser.
+ *
+ * The push parser lets the caller send the XML data in chunks of any
+ * size. Each chunk gets parsed as soon as it is received so parsing
+ * overlaps with the I/O.
+ *
+ * \code
+ *     basic_xml::push_parser p("socket");
+ *     for(;;)
+ *     {
+ *         ssize_t const r(read(s, buf, sizeof(buf)));
+ *         if(r <= 0)
+ *         {
+ *             break;
+ *         }
+ *         p.feed(buf, r);
+ *     }
+ *     p.finish();
+ *     basic_xml::node::pointer_t root(p.root());
+ * \endcode
+ */
+
+// self
+//
+#include    "basic-xml/push_parser.h"
+
+#include    "basic-xml/parser.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+/** \brief Initialize a push parser.
+ *
+ * This push parser builds a tree of nodes. Use root() to retrieve it
+ * once finish() returned.
+ *
+ * With untrusted input, use the \p options to limit the depth of the
+ * tree, the number of nodes, the memory used, etc.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] options  The options used to parse the input.
+ */
+push_parser::push_parser(std::string const & filename, parse_options const & options)
+    : f_parser(std::make_unique<parser>(filename, f_root, options))
+{
+}
+
+
+/** \brief Initialize a push parser sending events to a handler.
+ *
+ * This push parser does not build a tree. Instead, each element is
+ * sent to \p h as soon as it was fed. In this case, root() always
+ * returns a null pointer.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] h  The handler receiving the events.
+ * \param[in] options  The limits used while parsing the input.
+ */
+push_parser::push_parser(std::string const & filename, handler & h, parse_options const & options)
+    : f_parser(std::make_unique<parser>(filename, h, options))
+{
+}
+
+
+/** \brief Clean up the push parser.
+ *
+ * The destructor is defined here because the parser is not defined
+ * in the public header.
+ */
+push_parser::~push_parser()
+{
+}
+
+
+/** \brief Parse the next chunk of XML data.
+ *
+ * The chunk can end anywhere, including in the middle of a tag or of
+ * a multibyte UTF-8 character. The incomplete part is kept until the
+ * next call.
+ *
+ * If the data includes an error, the corresponding exception is raised
+ * and the push parser cannot be used anymore.
+ *
+ * \param[in] data  The bytes to parse.
+ * \param[in] size  The number of bytes in \p data.
+ */
+void push_parser::feed(char const * data, std::size_t size)
+{
+    f_parser->feed(data, size);
+}
+
+
+/** \brief Parse a chain of buffers.
+ *
+ * This function accepts the same array of buffers as readv(2) so the
+ * caller does not have to concatenate them.
+ *
+ * \param[in] chain  The array of buffers.
+ * \param[in] count  The number of buffers in \p chain.
+ */
+void push_parser::feed(iovec const * chain, std::size_t count)
+{
+    f_parser->feed(chain, count);
+}
+
+
+/** \brief Signal the end of the data.
+ *
+ * This function must be called once all the data was fed. It parses
+ * the last token and verifies that the document is complete.
+ *
+ * \exception unexpected_eof
+ * The data ended in the middle of a tag, comment, etc.
+ *
+ * \exception unexpected_token
+ * The root tag is missing or it was not closed.
+ */
+void push_parser::finish()
+{
+    f_parser->finish();
+}
+
+
+/** \brief Retrieve the root of the tree.
+ *
+ * The tree is built as the data gets fed. It is only complete once
+ * finish() returned.
+ *
+ * \return The root node or nullptr if the root tag was not yet found.
+ */
+node::pointer_t push_parser::root()
+{
+    return f_root;
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,73 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Parse XML received in chunks.
+ *
+ * The push_parser object accepts the XML data as it arrives (i.e. from
+ * a non-blocking socket) instead of requiring the whole document first.
+ */
+
+// self
+//
+#include    <basic-xml/handler.h>
+#include    <basic-xml/node.h>
+#include    <basic-xml/parse_options.h>
+
+
+// C
+//
+#include    <sys/uio.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+class parser;
+
+
+class push_parser
+{
+public:
+                                    push_parser(std::string const & filename, parse_options const & options = parse_options());
+                                    push_parser(std::string const & filename, handler & h, parse_options const & options = parse_options());
+                                    push_parser(push_parser const &) = delete;
+                                    ~push_parser();
+
+    push_parser &                   operator = (push_parser const &) = delete;
+
+    void                            feed(char const * data, std::size_t size);
+    void                            feed(iovec const * chain, std::size_t count);
+    void                            finish();
+
+    node::pointer_t                 root();
+
+private:
+    node::pointer_t                 f_root = node::pointer_t();
+    std::unique_ptr<parser>         f_parser{};
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,421 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the pull reader.
+ *
+ * The reader lets your code drive the parser:
+ *
+ * \code
+ *     basic_xml::reader r(filename);
+ *     while(r.next())
+ *     {
+ *         if(r.kind() == basic_xml::reader::kind_t::KIND_START_TAG)
+ *         {
+ *             if(r.name() != "table")
+ *             {
+ *                 r.skip_subtree();
+ *                 continue;
+ *             }
+ *             std::cout << r.attribute("name") << "\n";
+ *         }
+ *     }
+ * \endcode
+ *
+ * The reader parses one token at a time when next() gets called. No
+ * node gets created and the strings are reused from one element to the
+ * next.
+ */
+
+// self
+//
+#include    "basic-xml/reader.h"
+
+#include    "basic-xml/mapped_file.h"
+#include    "basic-xml/parser.h"
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief The value returned for undefined attributes.
+ *
+ * The attribute() function returns a reference. When the attribute is
+ * not defined, this empty string is returned.
+ */
+std::string const   g_empty_string = std::string();
+
+
+
+} // no name namespace
+
+
+
+/** \brief Read an XML file.
+ *
+ * The file gets memory mapped. When the file cannot be mapped (i.e. a
+ * pipe), it gets read in memory first.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \param[in] filename  The name of the file to read.
+ */
+reader::reader(std::string const & filename)
+    : f_file(std::make_unique<mapped_file>(filename))
+    , f_parser(std::make_unique<parser>(filename, f_file->data(), f_file->size(), static_cast<handler &>(*this)))
+{
+}
+
+
+/** \brief Read XML from a stream.
+ *
+ * The stream is read in blocks as the reader moves forward.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ */
+reader::reader(std::string const & filename, std::istream & in)
+    : f_parser(std::make_unique<parser>(filename, in, static_cast<handler &>(*this)))
+{
+}
+
+
+/** \brief Read XML from a buffer.
+ *
+ * The buffer must remain valid as long as the reader is in use.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] data  A pointer to the XML data.
+ * \param[in] size  The number of bytes in \p data.
+ */
+reader::reader(std::string const & filename, char const * data, std::size_t size)
+    : f_parser(std::make_unique<parser>(filename, data, size, static_cast<handler &>(*this)))
+{
+}
+
+
+/** \brief Clean up the reader.
+ *
+ * The destructor is defined here because the parser is not defined
+ * in the public header.
+ */
+reader::~reader()
+{
+}
+
+
+/** \brief Move to the next element.
+ *
+ * This function parses the input until the next element is found.
+ * Comments and spaces outside of the root tag are skipped.
+ *
+ * An empty tag (i.e. `<empty/>`) generates a KIND_START_TAG and then
+ * a KIND_END_TAG.
+ *
+ * \return true if an element was found, false at the end of the file.
+ */
+bool reader::next()
+{
+    if(f_pending_end)
+    {
+        f_pending_end = false;
+        f_kind = kind_t::KIND_END_TAG;
+        f_attribute_count = 0;
+        --f_open;
+        f_depth = f_open;
+        return true;
+    }
+
+    f_event = false;
+    while(!f_event)
+    {
+        if(!f_parser->step())
+        {
+            f_kind = kind_t::KIND_END_OF_FILE;
+            f_name.clear();
+            f_value.clear();
+            f_attribute_count = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/** \brief Skip the content of the current tag.
+ *
+ * When the reader is on a start tag, this function skips everything up
+ * to the corresponding end tag. The reader is then positioned on that
+ * end tag. The skipped elements are parsed (the input still needs to be
+ * verified) but they are not saved anywhere.
+ *
+ * On any other kind of element, this function does nothing.
+ */
+void reader::skip_subtree()
+{
+    if(f_kind != kind_t::KIND_START_TAG)
+    {
+        return;
+    }
+
+    if(f_pending_end)
+    {
+        next();
+        return;
+    }
+
+    f_skip = 1;
+    f_attribute_count = 0;
+    while(f_skip > 0
+       && f_parser->step())
+    {
+    }
+}
+
+
+/** \brief Get the kind of the current element.
+ *
+ * \return The kind of element the reader is on.
+ */
+reader::kind_t reader::kind() const
+{
+    return f_kind;
+}
+
+
+/** \brief Get the name of the current tag.
+ *
+ * \return The tag name of a start or end tag, an empty string otherwise.
+ */
+std::string const & reader::name() const
+{
+    return f_name;
+}
+
+
+/** \brief Get the value of the current element.
+ *
+ * \return The text or the processor content, an empty string otherwise.
+ */
+std::string const & reader::value() const
+{
+    return f_value;
+}
+
+
+/** \brief Get the depth of the current element.
+ *
+ * The root start and end tags are at depth 0. Its direct children are
+ * at depth 1, etc.
+ *
+ * \return The number of tags enclosing the current element.
+ */
+std::size_t reader::depth() const
+{
+    return f_depth;
+}
+
+
+/** \brief Get the number of attributes of the current start tag.
+ *
+ * \return The number of attributes or 0 if not on a start tag.
+ */
+std::size_t reader::attribute_count() const
+{
+    return f_attribute_count;
+}
+
+
+/** \brief Check whether the current start tag has the named attribute.
+ *
+ * \param[in] name  The name of the attribute.
+ *
+ * \return true if the attribute is defined.
+ */
+bool reader::has_attribute(std::string const & name) const
+{
+    for(std::size_t idx(0); idx < f_attribute_count; ++idx)
+    {
+        if(f_attributes[idx].first == name)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/** \brief Get the value of an attribute of the current start tag.
+ *
+ * \param[in] name  The name of the attribute.
+ *
+ * \return The value of the attribute or an empty string if not defined.
+ */
+std::string const & reader::attribute(std::string const & name) const
+{
+    for(std::size_t idx(0); idx < f_attribute_count; ++idx)
+    {
+        if(f_attributes[idx].first == name)
+        {
+            return f_attributes[idx].second;
+        }
+    }
+    return g_empty_string;
+}
+
+
+/** \brief Save a start tag event.
+ *
+ * While skipping a sub-tree, the event only increases the skip level.
+ *
+ * \param[in] name  The name of the tag.
+ */
+void reader::start_tag(std::string_view name)
+{
+    if(f_skip > 0)
+    {
+        ++f_skip;
+        return;
+    }
+
+    f_event = true;
+    f_kind = kind_t::KIND_START_TAG;
+    f_name = name;
+    f_value.clear();
+    f_attribute_count = 0;
+    f_depth = f_open;
+    ++f_open;
+}
+
+
+/** \brief Save an attribute of the current start tag.
+ *
+ * \param[in] name  The name of the attribute.
+ * \param[in] value  The value of the attribute.
+ */
+void reader::attribute(std::string_view name, std::string_view value)
+{
+    if(f_skip > 0)
+    {
+        return;
+    }
+
+    if(f_attribute_count >= f_attributes.size())
+    {
+        f_attributes.emplace_back();
+    }
+    f_attributes[f_attribute_count].first = name;
+    f_attributes[f_attribute_count].second = value;
+    ++f_attribute_count;
+}
+
+
+/** \brief Save a text event.
+ *
+ * \param[in] value  The text.
+ */
+void reader::text(std::string_view value)
+{
+    if(f_skip > 0)
+    {
+        return;
+    }
+
+    f_event = true;
+    f_kind = kind_t::KIND_TEXT;
+    f_name.clear();
+    f_value = value;
+    f_attribute_count = 0;
+    f_depth = f_open;
+}
+
+
+/** \brief Save an end tag event.
+ *
+ * For an empty tag, the start and end tag events are received in the
+ * same step. In that case the end tag is returned by the next call to
+ * next().
+ *
+ * \param[in] name  The name of the tag.
+ */
+void reader::end_tag(std::string_view name)
+{
+    if(f_skip > 0)
+    {
+        --f_skip;
+        if(f_skip > 0)
+        {
+            return;
+        }
+    }
+    else if(f_event)
+    {
+        // empty tag, the start tag event was sent in the same step
+        //
+        f_pending_end = true;
+        return;
+    }
+
+    f_event = true;
+    f_kind = kind_t::KIND_END_TAG;
+    f_name = name;
+    f_value.clear();
+    f_attribute_count = 0;
+    --f_open;
+    f_depth = f_open;
+}
+
+
+/** \brief Save a processor event.
+ *
+ * \param[in] value  The content of the processor tag.
+ */
+void reader::processor(std::string_view value)
+{
+    if(f_skip > 0)
+    {
+        return;
+    }
+
+    f_event = true;
+    f_kind = kind_t::KIND_PROCESSOR;
+    f_name.clear();
+    f_value = value;
+    f_attribute_count = 0;
+    f_depth = f_open;
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,108 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Read the XML one element at a time.
+ *
+ * The reader is a cursor over the XML input. Your code calls next() to
+ * move to the next element which means it can stop at any time or skip
+ * a whole sub-tree without building any node.
+ */
+
+// self
+//
+#include    <basic-xml/handler.h>
+
+
+// C++
+//
+#include    <memory>
+#include    <vector>
+
+
+
+namespace basic_xml
+{
+
+
+
+class mapped_file;
+class parser;
+
+
+class reader
+    : private handler
+{
+public:
+    enum class kind_t
+    {
+        KIND_NONE,
+        KIND_START_TAG,
+        KIND_END_TAG,
+        KIND_TEXT,
+        KIND_PROCESSOR,
+        KIND_END_OF_FILE
+    };
+
+                                    reader(std::string const & filename);
+                                    reader(std::string const & filename, std::istream & in);
+                                    reader(std::string const & filename, char const * data, std::size_t size);
+                                    reader(reader const &) = delete;
+    virtual                         ~reader();
+
+    reader &                        operator = (reader const &) = delete;
+
+    bool                            next();
+    void                            skip_subtree();
+
+    kind_t                          kind() const;
+    std::string const &             name() const;
+    std::string const &             value() const;
+    std::size_t                     depth() const;
+    std::size_t                     attribute_count() const;
+    bool                            has_attribute(std::string const & name) const;
+    std::string const &             attribute(std::string const & name) const;
+
+private:
+    virtual void                    start_tag(std::string_view name) override;
+    virtual void                    attribute(std::string_view name, std::string_view value) override;
+    virtual void                    text(std::string_view value) override;
+    virtual void                    end_tag(std::string_view name) override;
+    virtual void                    processor(std::string_view value) override;
+
+    std::unique_ptr<mapped_file>    f_file{};
+    std::unique_ptr<parser>         f_parser{};
+    kind_t                          f_kind = kind_t::KIND_NONE;
+    bool                            f_event = false;
+    bool                            f_pending_end = false;
+    std::size_t                     f_depth = 0;
+    std::size_t                     f_open = 0;
+    std::size_t                     f_skip = 0;
+    std::string                     f_name = std::string();
+    std::string                     f_value = std::string();
+    std::vector<std::pair<std::string, std::string>>
+                                    f_attributes = std::vector<std::pair<std::string, std::string>>();
+    std::size_t                     f_attribute_count = 0;
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
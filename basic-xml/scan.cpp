@@ -0,0 +1,838 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the character run scanners.
+ *
+ * The text and attribute values are mostly composed of characters that
+ * the parser copies as is. These functions find the next character
+ * which requires special handling so the parser can copy everything
+ * before it in one go.
+ *
+ * The scanners use SSE2 (16 bytes at a time) when the compiler supports
+ * it. On x86 processors, the AVX2 version (32 bytes at a time) gets
+ * compiled with the target attribute and is used when the processor
+ * supports it, which is checked at run time. The remaining bytes are
+ * checked one at a time.
+ *
+ * The input is validated as UTF-8 before the parser reads it. The
+ * validator uses the lookup algorithm from John Keiser and Daniel Lemire
+ * ("Validating UTF-8 In Less Than One Instruction Per Byte") when the
+ * processor supports SSSE3. Otherwise, blocks of ASCII characters are skipped
+ * 16 bytes at a time. Since the input is known to be valid, the scanners
+ * do not have to stop on multibyte characters.
+ *
+ * UTF-16 input gets converted to UTF-8 before it gets validated. Blocks
+ * of ASCII characters are converted with AVX2 or SSE2 as well.
+ */
+
+// self
+//
+#include    "basic-xml/scan.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <cstdint>
+
+
+// the AVX2 and SSSE3 functions get compiled with the target attribute
+// and the processor gets checked at run time
+//
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define BASIC_XML_X86
+#endif
+
+
+// C
+//
+#if defined(BASIC_XML_X86) || defined(__SSE2__)
+#include    <immintrin.h>
+#endif
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+#ifdef BASIC_XML_X86
+/** \brief Check whether the processor supports AVX2.
+ *
+ * The processor gets checked once. When the compiler already generates
+ * AVX2 code, the function always returns true.
+ *
+ * \return true if the AVX2 functions can be used.
+ */
+bool has_avx2()
+{
+#ifdef __AVX2__
+    return true;
+#else
+    static bool const avx2((__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0));
+    return avx2;
+#endif
+}
+
+
+/** \brief Search 32 bytes at a time for one of \p chars.
+ *
+ * This is the AVX2 part of find_special(). It stops on the first byte
+ * which find_special() searches for or when less than 32 bytes are left.
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ * \param[in] chars  The characters to search.
+ *
+ * \return A pointer to the byte found or to the last bytes to check.
+ */
+template<typename ...C>
+__attribute__((target("avx2")))
+char const * find_special_avx2(char const * s, char const * e, C ... chars)
+{
+    for(; e - s >= 32; s += 32)
+    {
+        __m256i const v(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(s)));
+        __m256i const m((... | _mm256_cmpeq_epi8(v, _mm256_set1_epi8(chars))));
+        int const mask(_mm256_movemask_epi8(m));
+        if(mask != 0)
+        {
+            return s + __builtin_ctz(mask);
+        }
+    }
+    return s;
+}
+#endif
+
+
+/** \brief Search for the first byte equal to one of \p chars.
+ *
+ * This function returns a pointer to the first byte which is equal to
+ * one of the \p chars.
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ * \param[in] chars  The characters to search.
+ *
+ * \return A pointer to the byte found or \p e.
+ */
+template<typename ...C>
+char const * find_special(char const * s, char const * e, C ... chars)
+{
+#ifdef BASIC_XML_X86
+    if(has_avx2())
+    {
+        s = find_special_avx2(s, e, chars...);
+    }
+#endif
+#ifdef __SSE2__
+    for(; e - s >= 16; s += 16)
+    {
+        __m128i const v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s)));
+        __m128i const m((... | _mm_cmpeq_epi8(v, _mm_set1_epi8(chars))));
+        int const mask(_mm_movemask_epi8(m));
+        if(mask != 0)
+        {
+            return s + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for(; s < e; ++s)
+    {
+        if(((*s == chars) || ...))
+        {
+            return s;
+        }
+    }
+    return e;
+}
+
+
+/** \brief Get the length of the UTF-8 sequence at \p s.
+ *
+ * This function checks the UTF-8 sequence starting at \p s. It returns
+ * its length in bytes if valid. Overlong sequences, surrogates, and
+ * characters over U+10FFFF are not valid.
+ *
+ * If the sequence is valid but ends after \p e, the function sets
+ * \p truncated to true and returns 0.
+ *
+ * \param[in] s  The start of the sequence.
+ * \param[in] e  The end of the buffer.
+ * \param[out] truncated  Set to true if the sequence is cut by \p e.
+ *
+ * \return The length of the sequence or 0 if invalid.
+ */
+std::size_t utf8_sequence_length(char const * s, char const * e, bool & truncated)
+{
+    std::uint8_t const c(*s);
+    if(c < 0x80)
+    {
+        return 1;
+    }
+
+    std::size_t length(0);
+    std::uint8_t lower(0x80);
+    std::uint8_t upper(0xBF);
+    if(c >= 0xC2 && c <= 0xDF)
+    {
+        length = 2;
+    }
+    else if(c >= 0xE0 && c <= 0xEF)
+    {
+        length = 3;
+        if(c == 0xE0)
+        {
+            lower = 0xA0;       // overlong
+        }
+        else if(c == 0xED)
+        {
+            upper = 0x9F;       // surrogates
+        }
+    }
+    else if(c >= 0xF0 && c <= 0xF4)
+    {
+        length = 4;
+        if(c == 0xF0)
+        {
+            lower = 0x90;       // overlong
+        }
+        else if(c == 0xF4)
+        {
+            upper = 0x8F;       // over U+10FFFF
+        }
+    }
+    else
+    {
+        return 0;
+    }
+
+    for(std::size_t idx(1); idx < length; ++idx)
+    {
+        if(s + idx >= e)
+        {
+            truncated = true;
+            return 0;
+        }
+        std::uint8_t const b(s[idx]);
+        if(b < lower || b > upper)
+        {
+            return 0;
+        }
+        lower = 0x80;
+        upper = 0xBF;
+    }
+
+    return length;
+}
+
+
+#ifdef BASIC_XML_X86
+/** \brief Check whether the processor supports SSSE3.
+ *
+ * \return true if the SSSE3 functions can be used.
+ */
+bool has_ssse3()
+{
+#ifdef __SSSE3__
+    return true;
+#else
+    static bool const ssse3((__builtin_cpu_init(), __builtin_cpu_supports("ssse3") != 0));
+    return ssse3;
+#endif
+}
+
+
+// the bits used by the lookup tables, a byte pair is an error if
+// all three tables have a common bit set
+//
+constexpr std::uint8_t const    TOO_SHORT      = 1 << 0;   // 11______ 0_______ or 11______ 11______
+constexpr std::uint8_t const    TOO_LONG       = 1 << 1;   // 0_______ 10______
+constexpr std::uint8_t const    OVERLONG_3     = 1 << 2;   // 11100000 100_____
+constexpr std::uint8_t const    TOO_LARGE      = 1 << 3;   // 11110100 1001____ and over
+constexpr std::uint8_t const    SURROGATE      = 1 << 4;   // 11101101 101_____
+constexpr std::uint8_t const    OVERLONG_2     = 1 << 5;   // 1100000_ 10______
+constexpr std::uint8_t const    TOO_LARGE_1000 = 1 << 6;   // 11110101 1000____ and over
+constexpr std::uint8_t const    OVERLONG_4     = 1 << 6;   // 11110000 1000____
+constexpr std::uint8_t const    TWO_CONTS      = 1 << 7;   // 10______ 10______
+constexpr std::uint8_t const    CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+
+__attribute__((target("ssse3")))
+__m128i lookup(__m128i table, __m128i v, int shift)
+{
+    return _mm_shuffle_epi8(
+              table
+            , _mm_and_si128(_mm_srli_epi16(v, shift), _mm_set1_epi8(0x0F)));
+}
+
+
+/** \brief Check 16 bytes of UTF-8.
+ *
+ * \param[in] input  The 16 bytes to check.
+ * \param[in] prev_input  The previous 16 bytes.
+ *
+ * \return A vector with non-zero bytes where an error was detected.
+ */
+__attribute__((target("ssse3")))
+__m128i check_utf8_block(__m128i input, __m128i prev_input)
+{
+    __m128i const byte_1_high(_mm_setr_epi8(
+              TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG
+            , TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG
+            , TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS
+            , TOO_SHORT | OVERLONG_2
+            , TOO_SHORT
+            , TOO_SHORT | OVERLONG_3 | SURROGATE
+            , TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4));
+    __m128i const byte_1_low(_mm_setr_epi8(
+              CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4
+            , CARRY | OVERLONG_2
+            , CARRY
+            , CARRY
+            , CARRY | TOO_LARGE
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE
+            , CARRY | TOO_LARGE | TOO_LARGE_1000
+            , CARRY | TOO_LARGE | TOO_LARGE_1000));
+    __m128i const byte_2_high(_mm_setr_epi8(
+              TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+            , TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+            , TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4
+            , TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE
+            , TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE
+            , TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE
+            , TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT));
+
+    // errors detected with the previous byte
+    //
+    __m128i const prev1(_mm_alignr_epi8(input, prev_input, 16 - 1));
+    __m128i const special_cases(_mm_and_si128(
+              _mm_and_si128(
+                      lookup(byte_1_high, prev1, 4)
+                    , lookup(byte_1_low, prev1, 0))
+            , lookup(byte_2_high, input, 4)));
+
+    // 3rd and 4th bytes must be continuation bytes
+    //
+    __m128i const prev2(_mm_alignr_epi8(input, prev_input, 16 - 2));
+    __m128i const prev3(_mm_alignr_epi8(input, prev_input, 16 - 3));
+    __m128i const is_third_byte(_mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80))));
+    __m128i const is_fourth_byte(_mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80))));
+    __m128i const must_be_continuation(_mm_and_si128(
+              _mm_or_si128(is_third_byte, is_fourth_byte)
+            , _mm_set1_epi8(static_cast<char>(0x80))));
+
+    return _mm_xor_si128(must_be_continuation, special_cases);
+}
+
+
+/** \brief Find the start of the sequence which includes \p s.
+ *
+ * When the vectorized validator detects an error, it can be caused by
+ * a sequence which started in the previous block. This function searches
+ * for the lead byte of a sequence which includes \p s.
+ *
+ * \param[in] start  The start of the buffer.
+ * \param[in] s  The position to check.
+ *
+ * \return The start of the sequence which includes \p s or \p s.
+ */
+char const * utf8_sequence_start(char const * start, char const * s)
+{
+    for(std::ptrdiff_t idx(1); idx <= 3 && idx <= s - start; ++idx)
+    {
+        std::uint8_t const c(s[-idx]);
+        if(c < 0x80)
+        {
+            break;
+        }
+        if(c >= 0xC0)
+        {
+            std::ptrdiff_t const length(c < 0xE0 ? 2 : (c < 0xF0 ? 3 : 4));
+            if(length > idx)
+            {
+                return s - idx;
+            }
+            break;
+        }
+    }
+    return s;
+}
+
+
+/** \brief Validate UTF-8 16 bytes at a time.
+ *
+ * This is the SSSE3 part of find_invalid_utf8(). It stops on the block
+ * where an error is detected or when less than 16 bytes are left. The
+ * caller checks the remaining bytes one at a time.
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ *
+ * \return A pointer to the first sequence to check one byte at a time.
+ */
+__attribute__((target("ssse3")))
+char const * skip_valid_utf8_ssse3(char const * s, char const * e)
+{
+    char const * const start(s);
+    __m128i prev_input(_mm_setzero_si128());
+    __m128i prev_incomplete(_mm_setzero_si128());
+    __m128i const max_value(_mm_setr_epi8(
+              -1, -1, -1, -1, -1, -1, -1, -1
+            , -1, -1, -1, -1, -1
+            , static_cast<char>(0xF0 - 1)
+            , static_cast<char>(0xE0 - 1)
+            , static_cast<char>(0xC0 - 1)));
+    for(; e - s >= 16; s += 16)
+    {
+        __m128i const input(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s)));
+        __m128i error;
+        if(_mm_movemask_epi8(input) == 0)
+        {
+            // plain ASCII, only the end of the previous block can be wrong
+            //
+            error = prev_incomplete;
+        }
+        else
+        {
+            error = check_utf8_block(input, prev_input);
+            prev_incomplete = _mm_subs_epu8(input, max_value);
+        }
+        if(_mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) != 0xFFFF)
+        {
+            // let the byte by byte loop find the exact position
+            //
+            break;
+        }
+        prev_input = input;
+    }
+    return utf8_sequence_start(start, s);
+}
+
+
+/** \brief Count the new lines 32 bytes at a time.
+ *
+ * This is the AVX2 part of count_lines(). The byte before \p s must be
+ * accessible. On return, \p s points to the last bytes to check, less
+ * than 32.
+ *
+ * \param[in,out] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ *
+ * \return The number of new lines found.
+ */
+__attribute__((target("avx2")))
+std::size_t count_lines_avx2(char const * & s, char const * e)
+{
+    std::size_t count(0);
+    for(; e - s >= 32; s += 32)
+    {
+        __m256i const v(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(s)));
+        __m256i const p(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(s - 1)));
+        __m256i const r(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+        __m256i const n(_mm256_andnot_si256(
+                  _mm256_cmpeq_epi8(p, _mm256_set1_epi8('\r'))
+                , _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+        count += __builtin_popcount(static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_or_si256(r, n))));
+    }
+    return count;
+}
+
+
+/** \brief Convert UTF-16 ASCII characters 16 code units at a time.
+ *
+ * This is the AVX2 part of convert_utf16(). It stops on the first block
+ * which includes a character other than ASCII or when less than 32 bytes
+ * are left.
+ *
+ * \param[in,out] s  The start of the UTF-16 buffer.
+ * \param[in] e  The end of the UTF-16 buffer.
+ * \param[in] big_endian  Whether the code units are big endian.
+ * \param[in,out] out  Where the UTF-8 gets written.
+ */
+__attribute__((target("avx2")))
+void convert_ascii_utf16_avx2(char const * & s, char const * e, bool big_endian, char * & out)
+{
+    for(; e - s >= 32; s += 32, out += 16)
+    {
+        __m256i v(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(s)));
+        if(big_endian)
+        {
+            v = _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8));
+        }
+        if(!_mm256_testz_si256(v, _mm256_set1_epi16(static_cast<short>(0xFF80))))
+        {
+            break;
+        }
+
+        // the pack works within each 128 bit lane, the permutation
+        // brings the two halves together
+        //
+        __m256i const packed(_mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm256_castsi256_si128(packed));
+    }
+}
+#endif
+
+
+
+} // no name namespace
+
+
+
+/** \brief Find the next character in text that needs special handling.
+ *
+ * The text parser stops on the following characters:
+ *
+ * \li '<' -- the start of a tag
+ * \li '&' -- the start of an entity
+ * \li '\\r' and '\\n' -- new lines are counted and "\\r\\n" gets converted
+ *
+ * The bytes of UTF-8 sequences are not special since the input was
+ * already validated with find_invalid_utf8().
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ *
+ * \return A pointer to the first special character or \p e.
+ */
+char const * find_text_special(char const * s, char const * e)
+{
+    return find_special(s, e, '<', '&', '\r', '\n');
+}
+
+
+/** \brief Find the next character in an attribute value that needs special handling.
+ *
+ * The attribute value parser stops on the closing \p quote, the '>'
+ * which is not allowed in a value, and the same characters as the
+ * find_text_special() function.
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ * \param[in] quote  The quote used to start the value (' or ").
+ *
+ * \return A pointer to the first special character or \p e.
+ */
+char const * find_value_special(char const * s, char const * e, char quote)
+{
+    return find_special(s, e, quote, '>', '&', '\r', '\n');
+}
+
+
+/** \brief Find the next character in a section that needs special handling.
+ *
+ * The comments, CDATA sections and processor tags end with a sequence
+ * of characters. The parser stops on the first character of that
+ * sequence, \p end, and on the new lines which it needs to count.
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ * \param[in] end  The first character of the sequence ending the section.
+ *
+ * \return A pointer to the first special character or \p e.
+ */
+char const * find_section_special(char const * s, char const * e, char end)
+{
+    return find_special(s, e, end, '\r', '\n');
+}
+
+
+/** \brief Count the new lines found in a buffer.
+ *
+ * The parser does not count lines as it goes. Instead, the line number
+ * is computed from the position when it is needed, which is mainly when
+ * an error occurs.
+ *
+ * A "\r\n" sequence counts as one new line, so a '\n' which follows
+ * a '\r' is not counted. Since such a sequence can be split between two
+ * buffers, \p cr tells whether the byte before \p s is a '\r'. On
+ * return, it is set to whether the last byte of the buffer is a '\r'.
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ * \param[in,out] cr  Whether the byte before \p s is a '\r'.
+ *
+ * \return The number of new lines found.
+ */
+std::size_t count_lines(char const * s, char const * e, bool & cr)
+{
+    if(s >= e)
+    {
+        return 0;
+    }
+
+    std::size_t count(0);
+    if(*s == '\r'
+    || (*s == '\n' && !cr))
+    {
+        ++count;
+    }
+    ++s;
+
+    // from here, s[-1] is always accessible
+    //
+#ifdef BASIC_XML_X86
+    if(has_avx2())
+    {
+        count += count_lines_avx2(s, e);
+    }
+#endif
+#ifdef __SSE2__
+    for(; e - s >= 16; s += 16)
+    {
+        __m128i const v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s)));
+        __m128i const p(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s - 1)));
+        __m128i const r(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+        __m128i const n(_mm_andnot_si128(
+                  _mm_cmpeq_epi8(p, _mm_set1_epi8('\r'))
+                , _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_or_si128(r, n)));
+    }
+#endif
+    for(; s < e; ++s)
+    {
+        if(*s == '\r'
+        || (*s == '\n' && s[-1] != '\r'))
+        {
+            ++count;
+        }
+    }
+
+    cr = e[-1] == '\r';
+    return count;
+}
+
+
+/** \brief Validate a buffer of UTF-8.
+ *
+ * This function checks that the bytes from \p s to \p e are valid UTF-8.
+ * It returns a pointer to the first byte of the first invalid sequence.
+ * If the whole buffer is valid, it returns \p e.
+ *
+ * When the buffer ends with the start of a valid sequence, the function
+ * returns a pointer to that last sequence and sets \p truncated to true.
+ * This happens when the input is read in blocks. The caller is expected
+ * to check those bytes again once more data is available.
+ *
+ * \param[in] s  The start of the buffer.
+ * \param[in] e  The end of the buffer.
+ * \param[out] truncated  Set to true if the invalid sequence is cut by \p e.
+ *
+ * \return A pointer to the first invalid sequence or \p e.
+ */
+char const * find_invalid_utf8(char const * s, char const * e, bool & truncated)
+{
+    truncated = false;
+    if(s == e)
+    {
+        return e;
+    }
+
+#ifdef BASIC_XML_X86
+    if(has_ssse3())
+    {
+        s = skip_valid_utf8_ssse3(s, e);
+    }
+    else
+#endif
+    {
+#ifdef __SSE2__
+        while(e - s >= 16)
+        {
+            __m128i const input(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s)));
+            if(_mm_movemask_epi8(input) == 0)
+            {
+                s += 16;
+                continue;
+            }
+            char const * const block_end(s + 16);
+            while(s < block_end)
+            {
+                std::size_t const length(utf8_sequence_length(s, e, truncated));
+                if(length == 0)
+                {
+                    return s;
+                }
+                s += length;
+            }
+        }
+#endif
+    }
+
+    while(s < e)
+    {
+        std::size_t const length(utf8_sequence_length(s, e, truncated));
+        if(length == 0)
+        {
+            return s;
+        }
+        s += length;
+    }
+
+    return e;
+}
+
+
+/** \brief Convert UTF-16 to UTF-8.
+ *
+ * This function converts the UTF-16 code units from \p s to \p e and
+ * writes the UTF-8 at \p out. The output buffer must have room for
+ * 3 bytes per code unit (i.e. 1.5 times the size of the input).
+ *
+ * Blocks of ASCII characters are converted 16 (AVX2) or 8 (SSE2) code
+ * units at a time. The other characters are converted one at a time.
+ *
+ * The function stops on an invalid surrogate and returns a pointer to
+ * it. When the buffer ends with an odd byte or with a high surrogate
+ * whose low surrogate is not available yet, it returns a pointer to
+ * those bytes and sets \p truncated to true. The caller is expected to
+ * convert them again once more data is available.
+ *
+ * \param[in] s  The start of the UTF-16 buffer.
+ * \param[in] e  The end of the UTF-16 buffer.
+ * \param[in] big_endian  Whether the code units are big endian.
+ * \param[in,out] out  Where the UTF-8 gets written; on return, the end
+ * of the UTF-8.
+ * \param[out] truncated  Set to true if the conversion stopped because
+ * the last character is cut by \p e.
+ *
+ * \return A pointer to the first byte which was not converted or \p e.
+ */
+char const * convert_utf16(char const * s, char const * e, bool big_endian, char * & out, bool & truncated)
+{
+    truncated = false;
+
+    auto const unit = [big_endian](char const * p) -> char32_t
+    {
+        std::uint8_t const a(p[0]);
+        std::uint8_t const b(p[1]);
+        return big_endian ? (a << 8) | b : (b << 8) | a;
+    };
+
+#ifdef BASIC_XML_X86
+    bool const avx2(has_avx2());
+#endif
+    while(e - s >= 2)
+    {
+#ifdef BASIC_XML_X86
+        if(avx2)
+        {
+            convert_ascii_utf16_avx2(s, e, big_endian, out);
+        }
+#endif
+#ifdef __SSE2__
+        for(; e - s >= 16; s += 16, out += 8)
+        {
+            __m128i v(_mm_loadu_si128(reinterpret_cast<__m128i const *>(s)));
+            if(big_endian)
+            {
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+            }
+            __m128i const ascii(_mm_cmpeq_epi16(
+                      _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)))
+                    , _mm_setzero_si128()));
+            if(_mm_movemask_epi8(ascii) != 0xFFFF)
+            {
+                break;
+            }
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out), _mm_packus_epi16(v, v));
+        }
+#endif
+
+        // convert the characters one at a time up to the next block
+        //
+        char const * const stop(s + std::min<std::size_t>((e - s) & ~static_cast<std::ptrdiff_t>(1), 16));
+        while(s < stop)
+        {
+            char32_t c(unit(s));
+            if(c < 0x80)
+            {
+                *out++ = static_cast<char>(c);
+                s += 2;
+            }
+            else if(c < 0x800)
+            {
+                *out++ = static_cast<char>((c >> 6) | 0xC0);
+                *out++ = static_cast<char>((c & 0x3F) | 0x80);
+                s += 2;
+            }
+            else if(c < 0xD800 || c >= 0xE000)
+            {
+                *out++ = static_cast<char>((c >> 12) | 0xE0);
+                *out++ = static_cast<char>(((c >> 6) & 0x3F) | 0x80);
+                *out++ = static_cast<char>((c & 0x3F) | 0x80);
+                s += 2;
+            }
+            else if(c < 0xDC00)
+            {
+                if(e - s < 4)
+                {
+                    truncated = true;
+                    return s;
+                }
+                char32_t const low(unit(s + 2));
+                if(low < 0xDC00 || low >= 0xE000)
+                {
+                    return s;
+                }
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                *out++ = static_cast<char>((c >> 18) | 0xF0);
+                *out++ = static_cast<char>(((c >> 12) & 0x3F) | 0x80);
+                *out++ = static_cast<char>(((c >> 6) & 0x3F) | 0x80);
+                *out++ = static_cast<char>((c & 0x3F) | 0x80);
+                s += 4;
+            }
+            else
+            {
+                // a low surrogate without a high surrogate
+                //
+                return s;
+            }
+        }
+    }
+
+    truncated = s != e;
+    return s;
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,57 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Fast scanning of runs of characters.
+ *
+ * These functions search a buffer for the next character which the
+ * parser needs to look at. Everything before that character can be
+ * copied as is.
+ *
+ * The find_invalid_utf8() function validates a whole buffer of UTF-8
+ * before the parser looks at it.
+ *
+ * The count_lines() function counts the new lines found in a buffer.
+ *
+ * The convert_utf16() function converts a buffer of UTF-16 to UTF-8.
+ */
+
+// C++
+//
+#include    <cstddef>
+
+
+
+namespace basic_xml
+{
+
+
+
+char const *    find_text_special(char const * s, char const * e);
+char const *    find_value_special(char const * s, char const * e, char quote);
+char const *    find_section_special(char const * s, char const * e, char end);
+char const *    find_invalid_utf8(char const * s, char const * e, bool & truncated);
+std::size_t     count_lines(char const * s, char const * e, bool & cr);
+char const *    convert_utf16(char const * s, char const * e, bool big_endian, char * & out, bool & truncated);
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
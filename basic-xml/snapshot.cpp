@@ -0,0 +1,820 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the binary snapshots.
+ *
+ * A snapshot file is composed of four parts:
+ *
+ * \code
+ *     header                       magic, version, counts, checksum
+ *     node_record[node_count]      one record per element
+ *     attribute_record[count]      the attributes of all the elements
+ *     strings                      the names, text and values
+ * \endcode
+ *
+ * The elements are saved breadth first starting with the root at index
+ * 0, so the children of an element are contiguous. The records refer
+ * to each other by index and to the strings by offset and length in
+ * the string table. The strings are deduplicated since the same tag
+ * and attribute names are used over and over again. The attributes of
+ * one element are sorted by name so they can be searched with a binary
+ * search.
+ *
+ * The numbers are saved in the byte order of the computer which creates
+ * the snapshot. A snapshot is expected to be created and used on the
+ * same kind of computer, like a cache.
+ *
+ * Loading a snapshot maps the file, verifies the header and the checksum
+ * and then each record once. After that, the accessors use the records
+ * as is.
+ */
+
+// self
+//
+#include    "basic-xml/snapshot.h"
+
+#include    "basic-xml/exception.h"
+#include    "basic-xml/mapped_file.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <unordered_map>
+#include    <vector>
+
+
+// C
+//
+#include    <string.h>
+
+
+// zlib
+//
+#include    <zlib.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief The magic at the start of a snapshot file.
+ *
+ * This is used to quickly detect that a file is not a snapshot.
+ */
+constexpr char const        g_magic[4] = { 'B', 'X', 'S', 'N' };
+
+
+/** \brief The current version of the snapshot format.
+ *
+ * Increment this version each time the format changes. Older snapshots
+ * get refused and need to be compiled again.
+ */
+constexpr std::uint32_t const SNAPSHOT_VERSION = 1;
+
+
+/** \brief Value used to detect the byte order of the snapshot.
+ *
+ * If this value reads differently, the snapshot was created on a
+ * computer with a different byte order.
+ */
+constexpr std::uint32_t const BYTE_ORDER_MARK = 0x01020304;
+
+
+/** \brief Index used when there is no parent, child or next element.
+ */
+constexpr std::uint32_t const NO_INDEX = 0xFFFFFFFF;
+
+
+/** \brief Largest block passed to crc32() at once.
+ *
+ * The zlib crc32() function takes the size as an unsigned int.
+ */
+constexpr std::size_t const CHECKSUM_BLOCK_SIZE = 1024 * 1024 * 1024;
+
+
+/** \brief The characters removed by text() when trimming.
+ */
+constexpr char const        g_spaces[] = " \t\n\r\v\f";
+
+
+std::uint32_t checksum(std::uint32_t crc, char const * data, std::size_t size)
+{
+    while(size > 0)
+    {
+        uInt const length(std::min(size, CHECKSUM_BLOCK_SIZE));
+        crc = crc32(crc, reinterpret_cast<Bytef const *>(data), length);
+        data += length;
+        size -= length;
+    }
+    return crc;
+}
+
+
+class string_table
+{
+public:
+    std::uint32_t                   add(std::string const & s);
+    std::string const &             data() const;
+
+private:
+    std::string                     f_data = std::string();
+    std::unordered_map<std::string, std::uint32_t>
+                                    f_offsets = std::unordered_map<std::string, std::uint32_t>();
+};
+
+
+std::uint32_t string_table::add(std::string const & s)
+{
+    if(s.empty())
+    {
+        return 0;
+    }
+
+    auto const it(f_offsets.find(s));
+    if(it != f_offsets.end())
+    {
+        return it->second;
+    }
+
+    if(f_data.length() + s.length() > NO_INDEX)
+    {
+        throw limit_exceeded("the strings of a snapshot cannot be more than 4Gb.");
+    }
+    std::uint32_t const offset(f_data.length());
+    f_data += s;
+    f_offsets[s] = offset;
+    return offset;
+}
+
+
+std::string const & string_table::data() const
+{
+    return f_data;
+}
+
+
+
+} // no name namespace
+
+
+
+struct snapshot::header
+{
+    char                            f_magic[4];
+    std::uint32_t                   f_version;
+    std::uint32_t                   f_byte_order;
+    std::uint32_t                   f_node_count;
+    std::uint32_t                   f_attribute_count;
+    std::uint32_t                   f_strings_size;
+    std::uint32_t                   f_checksum;
+    std::uint32_t                   f_reserved;
+};
+
+
+struct snapshot::node_record
+{
+    std::uint32_t                   f_name;
+    std::uint32_t                   f_name_length;
+    std::uint32_t                   f_text;
+    std::uint32_t                   f_text_length;
+    std::uint32_t                   f_parent;
+    std::uint32_t                   f_first_child;
+    std::uint32_t                   f_next;
+    std::uint32_t                   f_first_attribute;
+    std::uint32_t                   f_attribute_count;
+};
+
+
+struct snapshot::attribute_record
+{
+    std::uint32_t                   f_name;
+    std::uint32_t                   f_name_length;
+    std::uint32_t                   f_value;
+    std::uint32_t                   f_value_length;
+};
+
+
+
+/** \brief Initialize an element.
+ *
+ * The elements are created by the snapshot object.
+ *
+ * \param[in] s  The snapshot of this element.
+ * \param[in] index  The index of this element in the snapshot.
+ */
+snapshot::element::element(snapshot const * s, std::uint32_t index)
+    : f_snapshot(s)
+    , f_index(index)
+{
+}
+
+
+/** \brief Check whether this element exists.
+ *
+ * The first_child(), next() and parent() functions return an element
+ * which is false when there is no such element. None of the other
+ * functions can be used on such an element.
+ *
+ * \return true if the element is part of a snapshot.
+ */
+snapshot::element::operator bool () const
+{
+    return f_snapshot != nullptr;
+}
+
+
+/** \brief Check whether two elements are the same.
+ *
+ * \param[in] rhs  The other element.
+ *
+ * \return true if both elements are the same element of the same snapshot.
+ */
+bool snapshot::element::operator == (element const & rhs) const
+{
+    return f_snapshot == rhs.f_snapshot
+        && f_index == rhs.f_index;
+}
+
+
+/** \brief Check whether two elements are different.
+ *
+ * \param[in] rhs  The other element.
+ *
+ * \return true if the elements are not the same.
+ */
+bool snapshot::element::operator != (element const & rhs) const
+{
+    return !operator == (rhs);
+}
+
+
+/** \brief Get the name of this element.
+ *
+ * \return A view of the tag name in the snapshot.
+ */
+std::string_view snapshot::element::tag_name() const
+{
+    node_record const & n(f_snapshot->f_nodes[f_index]);
+    return f_snapshot->get_string(n.f_name, n.f_name_length);
+}
+
+
+/** \brief Get the text of this element.
+ *
+ * As with the node::text() function, the text is trimmed by default.
+ *
+ * \param[in] trim  Whether to remove the spaces at the start and end.
+ *
+ * \return A view of the text in the snapshot.
+ */
+std::string_view snapshot::element::text(bool trim) const
+{
+    node_record const & n(f_snapshot->f_nodes[f_index]);
+    std::string_view t(f_snapshot->get_string(n.f_text, n.f_text_length));
+    if(trim)
+    {
+        std::string_view::size_type const start(t.find_first_not_of(g_spaces));
+        if(start == std::string_view::npos)
+        {
+            return std::string_view();
+        }
+        t = t.substr(start, t.find_last_not_of(g_spaces) - start + 1);
+    }
+    return t;
+}
+
+
+/** \brief Get the number of attributes of this element.
+ *
+ * \return The number of attributes.
+ */
+std::size_t snapshot::element::attribute_count() const
+{
+    return f_snapshot->f_nodes[f_index].f_attribute_count;
+}
+
+
+/** \brief Get the name of an attribute.
+ *
+ * The attributes are sorted by name.
+ *
+ * \exception out_of_range
+ * The index is not smaller than attribute_count().
+ *
+ * \param[in] idx  The index of the attribute.
+ *
+ * \return A view of the name of the attribute.
+ */
+std::string_view snapshot::element::attribute_name(std::size_t idx) const
+{
+    node_record const & n(f_snapshot->f_nodes[f_index]);
+    if(idx >= n.f_attribute_count)
+    {
+        throw out_of_range("attribute index out of range.");
+    }
+    attribute_record const & a(f_snapshot->f_attributes[n.f_first_attribute + idx]);
+    return f_snapshot->get_string(a.f_name, a.f_name_length);
+}
+
+
+/** \brief Get the value of an attribute.
+ *
+ * \exception out_of_range
+ * The index is not smaller than attribute_count().
+ *
+ * \param[in] idx  The index of the attribute.
+ *
+ * \return A view of the value of the attribute.
+ */
+std::string_view snapshot::element::attribute_value(std::size_t idx) const
+{
+    node_record const & n(f_snapshot->f_nodes[f_index]);
+    if(idx >= n.f_attribute_count)
+    {
+        throw out_of_range("attribute index out of range.");
+    }
+    attribute_record const & a(f_snapshot->f_attributes[n.f_first_attribute + idx]);
+    return f_snapshot->get_string(a.f_value, a.f_value_length);
+}
+
+
+/** \brief Search an attribute by name.
+ *
+ * As with the node::attribute() function, an attribute which is not
+ * defined returns an empty string.
+ *
+ * \param[in] name  The name of the attribute to search.
+ *
+ * \return A view of the value of the attribute or an empty view.
+ */
+std::string_view snapshot::element::attribute(std::string_view name) const
+{
+    node_record const & n(f_snapshot->f_nodes[f_index]);
+    attribute_record const * begin(f_snapshot->f_attributes + n.f_first_attribute);
+    attribute_record const * end(begin + n.f_attribute_count);
+    attribute_record const * a(std::lower_bound(
+              begin
+            , end
+            , name
+            , [this](attribute_record const & r, std::string_view const & key)
+            {
+                return f_snapshot->get_string(r.f_name, r.f_name_length) < key;
+            }));
+    if(a == end
+    || f_snapshot->get_string(a->f_name, a->f_name_length) != name)
+    {
+        return std::string_view();
+    }
+    return f_snapshot->get_string(a->f_value, a->f_value_length);
+}
+
+
+/** \brief Get the parent of this element.
+ *
+ * \return The parent element or a false element for the root.
+ */
+snapshot::element snapshot::element::parent() const
+{
+    std::uint32_t const index(f_snapshot->f_nodes[f_index].f_parent);
+    if(index == NO_INDEX)
+    {
+        return element();
+    }
+    return element(f_snapshot, index);
+}
+
+
+/** \brief Get the first child of this element.
+ *
+ * \return The first child element or a false element.
+ */
+snapshot::element snapshot::element::first_child() const
+{
+    std::uint32_t const index(f_snapshot->f_nodes[f_index].f_first_child);
+    if(index == NO_INDEX)
+    {
+        return element();
+    }
+    return element(f_snapshot, index);
+}
+
+
+/** \brief Get the next sibling of this element.
+ *
+ * \return The next element or a false element.
+ */
+snapshot::element snapshot::element::next() const
+{
+    std::uint32_t const index(f_snapshot->f_nodes[f_index].f_next);
+    if(index == NO_INDEX)
+    {
+        return element();
+    }
+    return element(f_snapshot, index);
+}
+
+
+
+/** \brief Load a snapshot file.
+ *
+ * The file is memory mapped and used in place. It remains mapped as
+ * long as the snapshot object exists, so the views returned by the
+ * elements remain valid that long.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \exception invalid_snapshot
+ * The file is not a valid snapshot.
+ *
+ * \param[in] filename  The name of the snapshot file.
+ */
+snapshot::snapshot(std::string const & filename)
+    : f_file(std::make_unique<mapped_file>(filename))
+{
+    verify(filename, f_file->data(), f_file->size());
+}
+
+
+/** \brief Use a snapshot already in memory.
+ *
+ * The data is not copied. It has to remain valid as long as the snapshot
+ * object exists. It also has to be aligned on 4 bytes.
+ *
+ * \exception invalid_snapshot
+ * The data is not a valid snapshot.
+ *
+ * \param[in] data  The snapshot data.
+ * \param[in] size  The size of the snapshot in bytes.
+ */
+snapshot::snapshot(char const * data, std::size_t size)
+{
+    verify("snapshot", data, size);
+}
+
+
+/** \brief Release the snapshot.
+ *
+ * If the snapshot was loaded from a file, this function unmaps it.
+ */
+snapshot::~snapshot()
+{
+}
+
+
+/** \brief Get the root element.
+ *
+ * \return The root element of the snapshot.
+ */
+snapshot::element snapshot::root() const
+{
+    return element(this, 0);
+}
+
+
+/** \brief Get the number of elements in the snapshot.
+ *
+ * \return The number of elements, which is at least 1.
+ */
+std::size_t snapshot::size() const
+{
+    return f_node_count;
+}
+
+
+/** \brief Create a tree of nodes from the snapshot.
+ *
+ * This function is useful if you need to modify the document. The
+ * elements are otherwise read-only.
+ *
+ * \return The root node of the new tree.
+ */
+node::pointer_t snapshot::to_tree() const
+{
+    node::pointer_t const root(std::make_shared<node>(std::string(snapshot::root().tag_name())));
+
+    // avoid a recursive function, the tree can be very deep
+    //
+    std::vector<std::pair<element, node::pointer_t>> stack{ { snapshot::root(), root } };
+    while(!stack.empty())
+    {
+        element const e(stack.back().first);
+        node::pointer_t const n(stack.back().second);
+        stack.pop_back();
+
+        for(std::size_t idx(0); idx < e.attribute_count(); ++idx)
+        {
+            n->set_attribute(
+                      std::string(e.attribute_name(idx))
+                    , std::string(e.attribute_value(idx)));
+        }
+        n->set_text(std::string(e.text(false)));
+
+        for(element c(e.first_child()); c; c = c.next())
+        {
+            node::pointer_t const child(std::make_shared<node>(std::string(c.tag_name())));
+            n->append_child(child);
+            stack.emplace_back(c, child);
+        }
+    }
+
+    return root;
+}
+
+
+/** \brief Verify the snapshot data.
+ *
+ * This function verifies the header, the checksum and all the records
+ * of the snapshot. The indexes and offsets found in the records are
+ * checked once here so the accessors do not have to check them again.
+ *
+ * The children and next elements must have a larger index. Each element
+ * other than the root must be the first child or the next sibling of
+ * exactly one element and its parent index must match. This way a damaged
+ * snapshot cannot create a loop or share an element between two branches.
+ *
+ * \exception invalid_snapshot
+ * The data is not a valid snapshot.
+ *
+ * \param[in] name  The name used in error messages.
+ * \param[in] data  The snapshot data.
+ * \param[in] size  The size of the data in bytes.
+ */
+void snapshot::verify(std::string const & name, char const * data, std::size_t size)
+{
+    static_assert(sizeof(header) == 32);
+    static_assert(sizeof(node_record) == 36);
+    static_assert(sizeof(attribute_record) == 16);
+
+    if(size < sizeof(header))
+    {
+        throw invalid_snapshot(name + ": too small to be a snapshot.");
+    }
+    if(reinterpret_cast<std::uintptr_t>(data) % alignof(node_record) != 0)
+    {
+        throw invalid_snapshot(name + ": the snapshot data is not properly aligned.");
+    }
+
+    header h;
+    memcpy(&h, data, sizeof(h));
+    if(memcmp(h.f_magic, g_magic, sizeof(g_magic)) != 0)
+    {
+        throw invalid_snapshot(name + ": not a snapshot.");
+    }
+    if(h.f_byte_order != BYTE_ORDER_MARK)
+    {
+        throw invalid_snapshot(name + ": the snapshot was created on a computer with a different byte order.");
+    }
+    if(h.f_version != SNAPSHOT_VERSION)
+    {
+        throw invalid_snapshot(
+                  name
+                + ": unsupported snapshot version "
+                + std::to_string(h.f_version)
+                + ".");
+    }
+    std::uint64_t const expected(
+              sizeof(header)
+            + static_cast<std::uint64_t>(h.f_node_count) * sizeof(node_record)
+            + static_cast<std::uint64_t>(h.f_attribute_count) * sizeof(attribute_record)
+            + h.f_strings_size);
+    if(h.f_node_count == 0
+    || expected != size)
+    {
+        throw invalid_snapshot(name + ": the size of the snapshot does not match its header.");
+    }
+    if(checksum(0, data + sizeof(header), size - sizeof(header)) != h.f_checksum)
+    {
+        throw invalid_snapshot(name + ": invalid snapshot checksum.");
+    }
+
+    node_record const * nodes(reinterpret_cast<node_record const *>(data + sizeof(header)));
+    attribute_record const * attributes(reinterpret_cast<attribute_record const *>(nodes + h.f_node_count));
+    auto const valid_string = [&h](std::uint32_t offset, std::uint32_t length)
+    {
+        return static_cast<std::uint64_t>(offset) + length <= h.f_strings_size;
+    };
+    std::vector<bool> linked(h.f_node_count);
+    auto const valid_link = [&h, nodes, &linked](std::uint32_t link, std::uint32_t idx, std::uint32_t parent)
+    {
+        if(link == NO_INDEX)
+        {
+            return true;
+        }
+        if(link <= idx
+        || link >= h.f_node_count
+        || nodes[link].f_parent != parent
+        || linked[link])
+        {
+            return false;
+        }
+        linked[link] = true;
+        return true;
+    };
+    for(std::uint32_t idx(0); idx < h.f_node_count; ++idx)
+    {
+        node_record const & n(nodes[idx]);
+        if(!valid_string(n.f_name, n.f_name_length)
+        || n.f_name_length == 0
+        || !valid_string(n.f_text, n.f_text_length)
+        || (idx == 0
+                ? n.f_parent != NO_INDEX || n.f_next != NO_INDEX
+                : n.f_parent >= idx)
+        || !valid_link(n.f_first_child, idx, idx)
+        || !valid_link(n.f_next, idx, n.f_parent)
+        || static_cast<std::uint64_t>(n.f_first_attribute) + n.f_attribute_count > h.f_attribute_count)
+        {
+            throw invalid_snapshot(
+                      name
+                    + ": element "
+                    + std::to_string(idx)
+                    + " of the snapshot is invalid.");
+        }
+    }
+    auto const unlinked(std::find(linked.begin() + 1, linked.end(), false));
+    if(unlinked != linked.end())
+    {
+        throw invalid_snapshot(
+                  name
+                + ": element "
+                + std::to_string(unlinked - linked.begin())
+                + " of the snapshot is not attached to the tree.");
+    }
+    for(std::uint32_t idx(0); idx < h.f_attribute_count; ++idx)
+    {
+        attribute_record const & a(attributes[idx]);
+        if(!valid_string(a.f_name, a.f_name_length)
+        || !valid_string(a.f_value, a.f_value_length))
+        {
+            throw invalid_snapshot(
+                      name
+                    + ": attribute "
+                    + std::to_string(idx)
+                    + " of the snapshot is invalid.");
+        }
+    }
+
+    f_nodes = nodes;
+    f_attributes = attributes;
+    f_strings = reinterpret_cast<char const *>(attributes + h.f_attribute_count);
+    f_node_count = h.f_node_count;
+}
+
+
+/** \brief Get a string from the string table.
+ *
+ * \param[in] offset  The offset of the string in the table.
+ * \param[in] length  The length of the string.
+ *
+ * \return A view of the string.
+ */
+std::string_view snapshot::get_string(std::uint32_t offset, std::uint32_t length) const
+{
+    return std::string_view(f_strings + offset, length);
+}
+
+
+
+/** \brief Save a tree of nodes as a snapshot.
+ *
+ * The output is expected to be a file opened in binary mode. The
+ * snapshot can then be loaded with the snapshot object.
+ *
+ * The text is saved as is (not trimmed). The entities do not need
+ * to be converted since the snapshot is not XML.
+ *
+ * \exception limit_exceeded
+ * The tree is too large to be saved in a snapshot (4 billion elements
+ * or 4Gb of strings).
+ *
+ * \exception io_error
+ * The snapshot could not be written to \p out.
+ *
+ * \param[in,out] out  The stream where the snapshot gets written.
+ * \param[in] root  The root of the tree to save.
+ */
+void write_snapshot(std::ostream & out, node const & root)
+{
+    std::vector<snapshot::node_record> nodes;
+    std::vector<snapshot::attribute_record> attributes;
+    string_table strings;
+
+    // save the nodes breadth first; nodes[idx] is the record of queue[idx]
+    //
+    std::vector<node const *> queue{ &root };
+    nodes.push_back(snapshot::node_record{ 0, 0, 0, 0, NO_INDEX, NO_INDEX, NO_INDEX, 0, 0 });
+    for(std::size_t idx(0); idx < queue.size(); ++idx)
+    {
+        node const * n(queue[idx]);
+
+        std::string const & name(n->tag_name());
+        nodes[idx].f_name = strings.add(name);
+        nodes[idx].f_name_length = name.length();
+
+        std::string const text(n->text(false));
+        nodes[idx].f_text = strings.add(text);
+        nodes[idx].f_text_length = text.length();
+
+        // the map is sorted by name, which the binary search expects
+        //
+        node::attribute_map_t const attrs(n->all_attributes());
+        nodes[idx].f_first_attribute = attributes.size();
+        nodes[idx].f_attribute_count = attrs.size();
+        for(auto const & a : attrs)
+        {
+            if(attributes.size() >= NO_INDEX)
+            {
+                throw limit_exceeded("a snapshot cannot have more than 4 billion attributes.");
+            }
+            attributes.push_back(snapshot::attribute_record{
+                      strings.add(a.first)
+                    , static_cast<std::uint32_t>(a.first.length())
+                    , strings.add(a.second)
+                    , static_cast<std::uint32_t>(a.second.length()) });
+        }
+
+        std::uint32_t previous(NO_INDEX);
+        for(node::pointer_t c(n->first_child()); c != nullptr; c = c->next())
+        {
+            if(nodes.size() >= NO_INDEX)
+            {
+                throw limit_exceeded("a snapshot cannot have more than 4 billion elements.");
+            }
+            std::uint32_t const child(nodes.size());
+            nodes.push_back(snapshot::node_record{ 0, 0, 0, 0, static_cast<std::uint32_t>(idx), NO_INDEX, NO_INDEX, 0, 0 });
+            if(previous == NO_INDEX)
+            {
+                nodes[idx].f_first_child = child;
+            }
+            else
+            {
+                nodes[previous].f_next = child;
+            }
+            previous = child;
+
+            // the children remain owned by the tree while we work on it
+            //
+            queue.push_back(c.get());
+        }
+    }
+
+    char const * node_data(reinterpret_cast<char const *>(nodes.data()));
+    std::size_t const node_size(nodes.size() * sizeof(snapshot::node_record));
+    char const * attribute_data(reinterpret_cast<char const *>(attributes.data()));
+    std::size_t const attribute_size(attributes.size() * sizeof(snapshot::attribute_record));
+    std::string const & string_data(strings.data());
+
+    snapshot::header h = {};
+    memcpy(h.f_magic, g_magic, sizeof(g_magic));
+    h.f_version = SNAPSHOT_VERSION;
+    h.f_byte_order = BYTE_ORDER_MARK;
+    h.f_node_count = nodes.size();
+    h.f_attribute_count = attributes.size();
+    h.f_strings_size = string_data.length();
+    h.f_checksum = checksum(0, node_data, node_size);
+    h.f_checksum = checksum(h.f_checksum, attribute_data, attribute_size);
+    h.f_checksum = checksum(h.f_checksum, string_data.data(), string_data.length());
+
+    out.write(reinterpret_cast<char const *>(&h), sizeof(h));
+    out.write(node_data, node_size);
+    out.write(attribute_data, attribute_size);
+    out.write(string_data.data(), string_data.length());
+    if(!out)
+    {
+        throw io_error("could not write the snapshot.");
+    }
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
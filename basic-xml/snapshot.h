@@ -0,0 +1,120 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Binary snapshot of a tree of nodes.
+ *
+ * A snapshot is a compiled version of an XML document. It is loaded by
+ * mapping the file in memory and it gets used in place: the elements
+ * are referenced by index and the names and text are views of a string
+ * table. No node gets allocated so loading a large document costs about
+ * the same as checking its checksum.
+ */
+
+// self
+//
+#include    <basic-xml/node.h>
+
+
+// C++
+//
+#include    <cstdint>
+#include    <memory>
+#include    <ostream>
+#include    <string>
+#include    <string_view>
+
+
+
+namespace basic_xml
+{
+
+
+
+class mapped_file;
+
+
+class snapshot
+{
+public:
+    class element
+    {
+    public:
+                                    element() = default;
+
+        explicit                    operator bool () const;
+        bool                        operator == (element const & rhs) const;
+        bool                        operator != (element const & rhs) const;
+
+        std::string_view            tag_name() const;
+        std::string_view            text(bool trim = true) const;
+        std::size_t                 attribute_count() const;
+        std::string_view            attribute_name(std::size_t idx) const;
+        std::string_view            attribute_value(std::size_t idx) const;
+        std::string_view            attribute(std::string_view name) const;
+
+        element                     parent() const;
+        element                     first_child() const;
+        element                     next() const;
+
+    private:
+        friend class snapshot;
+
+                                    element(snapshot const * s, std::uint32_t index);
+
+        snapshot const *            f_snapshot = nullptr;
+        std::uint32_t               f_index = 0;
+    };
+
+                                    snapshot(std::string const & filename);
+                                    snapshot(char const * data, std::size_t size);
+                                    snapshot(snapshot const &) = delete;
+                                    ~snapshot();
+
+    snapshot &                      operator = (snapshot const &) = delete;
+
+    element                         root() const;
+    std::size_t                     size() const;
+    node::pointer_t                 to_tree() const;
+
+private:
+    friend void                     write_snapshot(std::ostream & out, node const & root);
+
+    struct header;
+    struct node_record;
+    struct attribute_record;
+
+    void                            verify(std::string const & name, char const * data, std::size_t size);
+    std::string_view                get_string(std::uint32_t offset, std::uint32_t length) const;
+
+    std::unique_ptr<mapped_file>    f_file{};
+    node_record const *             f_nodes = nullptr;
+    attribute_record const *        f_attributes = nullptr;
+    char const *                    f_strings = nullptr;
+    std::uint32_t                   f_node_count = 0;
+};
+
+
+void                                write_snapshot(std::ostream & out, node const & root);
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,145 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+/** \file
+ * \brief Implementation of the tree builder.
+ *
+ * The tree builder transforms the parser events in a tree of nodes.
+ */
+
+// self
+//
+#include    "basic-xml/tree_builder.h"
+
+
+// snapdev
+//
+#include    <snapdev/not_used.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+/** \brief Initialize the tree builder.
+ *
+ * In lazy mode, the parser does not decode the entities of the text
+ * and attribute values. The builder saves them as is and the nodes
+ * decode them on the first access.
+ *
+ * With an arena, all the nodes, their text and their attributes get
+ * allocated from a few large blocks instead of one heap allocation each.
+ * The whole tree is released at once when its last node goes away.
+ *
+ * \param[out] root  The pointer where the root node gets saved.
+ * \param[in] decode  Whether the entities were already decoded.
+ * \param[in] use_arena  Whether to allocate the nodes from an arena.
+ */
+tree_builder::tree_builder(node::pointer_t & root, decode_t decode, bool use_arena)
+    : f_root(root)
+    , f_decode(decode)
+{
+    if(use_arena)
+    {
+        f_arena = std::make_shared<arena>();
+    }
+}
+
+
+/** \brief Create a new node.
+ *
+ * The first node becomes the root. The others are added as children
+ * of the current node. The new node becomes the current node.
+ *
+ * \param[in] name  The name of the tag.
+ */
+void tree_builder::start_tag(std::string_view name)
+{
+    node::pointer_t n(f_arena == nullptr
+            ? std::make_shared<node>(name, std::pmr::get_default_resource())
+            : std::allocate_shared<node>(arena_allocator<node>(f_arena), name, f_arena.get()));
+    if(f_parent == nullptr)
+    {
+        f_root = n;
+    }
+    else
+    {
+        f_parent->append_child(n);
+    }
+    f_parent = n;
+}
+
+
+/** \brief Add an attribute to the current node.
+ *
+ * \param[in] name  The name of the attribute.
+ * \param[in] value  The value of the attribute.
+ */
+void tree_builder::attribute(std::string_view name, std::string_view value)
+{
+    if(f_decode == decode_t::DECODE_LAZY)
+    {
+        f_parent->append_raw_attribute(name, value);
+    }
+    else
+    {
+        f_parent->append_parsed_attribute(name, value);
+    }
+}
+
+
+/** \brief Add text to the current node.
+ *
+ * \param[in] value  The text to append.
+ */
+void tree_builder::text(std::string_view value)
+{
+    if(f_decode == decode_t::DECODE_LAZY)
+    {
+        f_parent->append_raw_text(value);
+    }
+    else
+    {
+        f_parent->append_parsed_text(value);
+    }
+}
+
+
+/** \brief Go back to the parent node.
+ *
+ * \param[in] name  The name of the tag, which the parser already verified.
+ */
+void tree_builder::end_tag(std::string_view name)
+{
+    snapdev::NOT_USED(name);
+
+    f_parent = f_parent->parent();
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,62 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Handler building a tree of nodes.
+ *
+ * This handler is used by the xml object to create the tree of nodes
+ * from the parser events.
+ */
+
+// self
+//
+#include    <basic-xml/arena.h>
+#include    <basic-xml/handler.h>
+#include    <basic-xml/node.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+class tree_builder
+    : public handler
+{
+public:
+                                    tree_builder(node::pointer_t & root, decode_t decode = decode_t::DECODE_NOW, bool use_arena = false);
+
+    virtual void                    start_tag(std::string_view name) override;
+    virtual void                    attribute(std::string_view name, std::string_view value) override;
+    virtual void                    text(std::string_view value) override;
+    virtual void                    end_tag(std::string_view name) override;
+
+private:
+    node::pointer_t &               f_root;
+    node::pointer_t                 f_parent = node::pointer_t();
+    decode_t                        f_decode = decode_t::DECODE_NOW;
+    arena::pointer_t                f_arena = arena::pointer_t();
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -46,15 +46,12 @@
 //
 #include    "basic-xml/type.h"
 
-
-// libutf8
-//
-#include    <libutf8/iterator.h>
+#include    "basic-xml/scan.h"
 
 
 // C++
 //
-#include    <iostream>
+#include    <cstdint>
 
 
 // last include
@@ -78,11 +75,6 @@ struct char_range_t
 {
     char32_t        f_first = U'\0';
     char32_t        f_last = U'\0';
-
-    bool operator < (char_range_t const & rhs) const
-    {
-        return f_last < rhs.f_first;
-    }
 };
 
 
@@ -130,16 +122,183 @@ constexpr char_range_t const g_name_char[] =
 };
 
 
-bool find_char(char32_t c, char_range_t const * b, char_range_t const * e)
+/** \brief Flags saved in the character tables.
+ *
+ * Each character gets a set of flags defining whether it can be used
+ * to start a name and whether it can be used in a name.
+ */
+constexpr std::uint8_t const    NAME_START_CHAR = 0x01;
+constexpr std::uint8_t const    NAME_CHAR = 0x02;
+
+/** \brief Flag used to mark uniform pages.
+ *
+ * A page where all the characters have the same flags is not saved in
+ * the table of pages. Instead, the page index is set to this flag along
+ * with the flags of all its characters.
+ */
+constexpr std::uint8_t const    UNIFORM_PAGE = 0x80;
+
+constexpr char32_t const        MAX_CHAR = 0x110000;
+constexpr std::size_t const     PAGE_SHIFT = 8;
+constexpr std::size_t const     PAGE_SIZE = 1 << PAGE_SHIFT;
+constexpr std::size_t const     PAGE_COUNT = MAX_CHAR / PAGE_SIZE;
+
+
+/** \brief Compute the flags of a character from the ranges.
+ *
+ * This function is only used at compile time to generate the tables.
+ *
+ * \param[in] c  The character to check.
+ *
+ * \return The flags of \p c.
+ */
+constexpr std::uint8_t char_flags(char32_t c)
+{
+    std::uint8_t flags(0);
+    for(auto const & r : g_name_start_char)
+    {
+        if(c >= r.f_first && c <= r.f_last)
+        {
+            flags |= NAME_START_CHAR;
+        }
+    }
+    for(auto const & r : g_name_char)
+    {
+        if(c >= r.f_first && c <= r.f_last)
+        {
+            flags |= NAME_CHAR;
+        }
+    }
+    return flags;
+}
+
+
+/** \brief Check whether a range boundary falls inside a page.
+ *
+ * \param[in] first  The first character of the page.
+ * \param[in] ranges  The ranges to check.
+ *
+ * \return true if the flags change within that page.
+ */
+template<std::size_t N>
+constexpr bool has_boundary(char32_t first, char_range_t const (&ranges)[N])
+{
+    for(auto const & r : ranges)
+    {
+        if((r.f_first > first && r.f_first < first + PAGE_SIZE)
+        || (r.f_last >= first && r.f_last < first + PAGE_SIZE - 1))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+constexpr bool is_mixed_page(std::size_t page)
 {
-    char_range_t r = { c, c };
-    auto range(std::lower_bound(b, e, r));
-//std::cout << std::flush;
-//std::cout << "--- searched character " << std::hex << "0x" << static_cast<int>(c) << " -> found range: 0x"
-//<< (range == e ? '?' : static_cast<int>(range->f_first)) << " ... 0x"
-//<< (range == e ? '?' : static_cast<int>(range->f_last))
-//<< std::endl;
-    return range != e && c >= range->f_first && c <= range->f_last;
+    char32_t const first(static_cast<char32_t>(page << PAGE_SHIFT));
+    return has_boundary(first, g_name_start_char)
+        || has_boundary(first, g_name_char);
+}
+
+
+constexpr std::size_t count_mixed_pages()
+{
+    std::size_t count(0);
+    for(std::size_t page(0); page < PAGE_COUNT; ++page)
+    {
+        if(is_mixed_page(page))
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+constexpr std::size_t const     MIXED_PAGE_COUNT = count_mixed_pages();
+
+static_assert(MIXED_PAGE_COUNT < UNIFORM_PAGE, "too many mixed pages for the page index to fit in 7 bits");
+
+
+/** \brief The two level character table.
+ *
+ * The f_page array has one entry per page of 256 characters. If the
+ * UNIFORM_PAGE bit is set, all the characters in that page have the
+ * same flags (the other bits). Otherwise the entry is an index in
+ * the f_mixed array which has the flags of each character.
+ *
+ * The f_ascii table is a copy of the flags of the first 128 characters
+ * since those are by far the most used.
+ */
+struct char_table_t
+{
+    std::uint8_t    f_ascii[128] = {};
+    std::uint8_t    f_page[PAGE_COUNT] = {};
+    std::uint8_t    f_mixed[MIXED_PAGE_COUNT][PAGE_SIZE] = {};
+};
+
+
+constexpr char_table_t generate_char_table()
+{
+    char_table_t table;
+
+    for(char32_t c(0); c < 128; ++c)
+    {
+        table.f_ascii[c] = char_flags(c);
+    }
+
+    std::size_t mixed(0);
+    for(std::size_t page(0); page < PAGE_COUNT; ++page)
+    {
+        char32_t const first(static_cast<char32_t>(page << PAGE_SHIFT));
+        if(is_mixed_page(page))
+        {
+            table.f_page[page] = static_cast<std::uint8_t>(mixed);
+            for(std::size_t idx(0); idx < PAGE_SIZE; ++idx)
+            {
+                table.f_mixed[mixed][idx] = char_flags(first + idx);
+            }
+            ++mixed;
+        }
+        else
+        {
+            table.f_page[page] = UNIFORM_PAGE | char_flags(first);
+        }
+    }
+
+    return table;
+}
+
+
+constexpr char_table_t const    g_char_table = generate_char_table();
+
+
+/** \brief Get the flags of a character.
+ *
+ * This function returns the flags of any character in constant time.
+ *
+ * \param[in] c  The character to check.
+ *
+ * \return The flags of \p c or 0 if \p c is out of range.
+ */
+inline std::uint8_t get_flags(char32_t c)
+{
+    if(c < 128)
+    {
+        return g_char_table.f_ascii[c];
+    }
+    if(c >= MAX_CHAR)
+    {
+        return 0;
+    }
+    std::uint8_t const page(g_char_table.f_page[c >> PAGE_SHIFT]);
+    if((page & UNIFORM_PAGE) != 0)
+    {
+        return page & ~UNIFORM_PAGE;
+    }
+    return g_char_table.f_mixed[page][c & (PAGE_SIZE - 1)];
 }
 
 
@@ -149,13 +308,13 @@ bool find_char(char32_t c, char_range_t const * b, char_range_t const * e)
 
 bool is_name_start_char(char32_t c)
 {
-    return find_char(c, std::begin(g_name_start_char), std::end(g_name_start_char));
+    return (get_flags(c) & NAME_START_CHAR) != 0;
 }
 
 
 bool is_name_char(char32_t c)
 {
-    return find_char(c, std::begin(g_name_char), std::end(g_name_char));
+    return (get_flags(c) & NAME_CHAR) != 0;
 }
 
 
@@ -203,27 +362,64 @@ bool is_space(char32_t c)
  */
 bool is_token(std::string const & token)
 {
-    if(token.empty())
-    {
-        return false;
-    }
+    return is_token(token.data(), token.length());
+}
 
-    libutf8::utf8_iterator it(token);
 
-    // here it != token.end() is always true since the token is not empty
-    // so there is no need to check that again
-    //
-    if(!is_name_start_char(*it))
+/** \brief Verify that the \p length bytes at \p s are a valid token.
+ *
+ * This function checks the token in a single pass over its bytes. ASCII
+ * characters are checked directly in the ASCII table. Other characters
+ * are decoded from UTF-8 and checked in the two level table.
+ *
+ * If the bytes are not valid UTF-8, the function returns false.
+ *
+ * \param[in] s  The bytes of the token.
+ * \param[in] length  The number of bytes in \p s.
+ *
+ * \return true if the string represents a valid token name.
+ */
+bool is_token(char const * s, std::size_t length)
+{
+    if(length == 0)
     {
         return false;
     }
 
-    for(++it; it != token.end(); ++it)
+    char const * const e(s + length);
+    std::uint8_t expected(NAME_START_CHAR);
+    while(s < e)
     {
-        if(!is_name_char(*it))
+        std::uint8_t const c(*s);
+        if(c < 0x80)
+        {
+            if((g_char_table.f_ascii[c] & expected) == 0)
+            {
+                return false;
+            }
+            ++s;
+        }
+        else
         {
-            return false;
+            bool truncated(false);
+            std::size_t const size(c < 0xE0 ? 2 : (c < 0xF0 ? 3 : 4));
+            if(static_cast<std::size_t>(e - s) < size
+            || find_invalid_utf8(s, s + size, truncated) != s + size)
+            {
+                return false;
+            }
+            char32_t wc(c & (0x7F >> size));
+            for(std::size_t idx(1); idx < size; ++idx)
+            {
+                wc = (wc << 6) | (s[idx] & 0x3F);
+            }
+            if((get_flags(wc) & expected) == 0)
+            {
+                return false;
+            }
+            s += size;
         }
+        expected = NAME_CHAR;
     }
 
     return true;
@@ -40,6 +40,7 @@ bool is_name_char(char32_t c);
 bool is_digit(char32_t c);
 bool is_space(char32_t c);
 bool is_token(std::string const & token);
+bool is_token(char const * s, std::size_t length);
 
 
 
@@ -0,0 +1,278 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the UTF-16 streams.
+ *
+ * XML documents can be encoded in UTF-16, in which case they must start
+ * with a byte order mark (BOM). The parser works with UTF-8 only, so
+ * these streams convert the data in large blocks as the parser reads
+ * it. That way the document does not need to be converted in a separate
+ * pass (and a temporary file) first.
+ *
+ * \code
+ *     std::ifstream in("feed.xml");
+ *     basic_xml::utf16_istream u(in);
+ *     basic_xml::xml x("feed.xml", u);
+ * \endcode
+ *
+ * The byte order mark itself is not part of the output.
+ */
+
+// self
+//
+#include    "basic-xml/utf16.h"
+
+#include    "basic-xml/exception.h"
+#include    "basic-xml/scan.h"
+
+
+// C++
+//
+#include    <algorithm>
+
+
+// C
+//
+#include    <string.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Size of the blocks of UTF-16 converted at once.
+ */
+constexpr std::size_t const     UTF16_BLOCK_SIZE = 64 * 1024;
+
+
+
+} // no name namespace
+
+
+
+/** \brief Check whether a buffer starts with a UTF-16 byte order mark.
+ *
+ * \param[in] data  The data to check.
+ * \param[in] size  The number of bytes in \p data.
+ *
+ * \return true if \p data starts with a UTF-16 little or big endian BOM.
+ */
+bool is_utf16(char const * data, std::size_t size)
+{
+    if(size < 2)
+    {
+        return false;
+    }
+    unsigned char const a(data[0]);
+    unsigned char const b(data[1]);
+    return (a == 0xFF && b == 0xFE)
+        || (a == 0xFE && b == 0xFF);
+}
+
+
+/** \brief Convert the UTF-16 data read from a stream.
+ *
+ * The byte order mark is read immediately. The rest of the data is read
+ * from \p in in blocks as required.
+ *
+ * \exception invalid_utf16
+ * The stream does not start with a byte order mark.
+ *
+ * \param[in] in  The stream with the UTF-16 data.
+ */
+utf16_istreambuf::utf16_istreambuf(std::istream & in)
+    : f_in(&in)
+    , f_input(UTF16_BLOCK_SIZE)
+    , f_output(UTF16_BLOCK_SIZE / 2 * 3)
+{
+    char bom[2];
+    std::streamsize const size(f_in->rdbuf()->sgetn(bom, sizeof(bom)));
+    read_byte_order_mark(bom, std::max(size, static_cast<std::streamsize>(0)));
+    f_next = f_input.data();
+    f_end = f_next;
+}
+
+
+/** \brief Convert the UTF-16 data found in a buffer.
+ *
+ * The buffer must remain valid as long as the stream buffer is in use.
+ * It gets converted directly, without first being copied.
+ *
+ * \exception invalid_utf16
+ * The buffer does not start with a byte order mark.
+ *
+ * \param[in] data  The UTF-16 data.
+ * \param[in] size  The number of bytes in \p data.
+ */
+utf16_istreambuf::utf16_istreambuf(char const * data, std::size_t size)
+    : f_next(data + std::min(size, static_cast<std::size_t>(2)))
+    , f_end(data + size)
+    , f_eof(true)
+    , f_output(UTF16_BLOCK_SIZE / 2 * 3)
+{
+    read_byte_order_mark(data, size);
+}
+
+
+/** \brief Check the byte order mark.
+ *
+ * UTF-16 XML documents must start with a byte order mark. It tells us
+ * whether the data is little or big endian.
+ *
+ * \exception invalid_utf16
+ * The data does not start with a byte order mark.
+ *
+ * \param[in] bom  The first bytes of the data.
+ * \param[in] size  The number of bytes in \p bom.
+ */
+void utf16_istreambuf::read_byte_order_mark(char const * bom, std::size_t size)
+{
+    if(!is_utf16(bom, size))
+    {
+        throw invalid_utf16("UTF-16 data must start with a byte order mark.");
+    }
+    f_big_endian = static_cast<unsigned char>(bom[0]) == 0xFE;
+    setg(f_output.data(), f_output.data(), f_output.data());
+}
+
+
+/** \brief Read the next block of UTF-16 data.
+ *
+ * The bytes which were not converted yet (i.e. half of a surrogate
+ * pair) are moved to the start of the input buffer first.
+ *
+ * \return false if no more data is available.
+ */
+bool utf16_istreambuf::fill_input()
+{
+    std::size_t const left(f_end - f_next);
+    memmove(f_input.data(), f_next, left);
+    std::streamsize const size(f_in->rdbuf()->sgetn(
+                  f_input.data() + left
+                , f_input.size() - left));
+    f_next = f_input.data();
+    f_end = f_next + left + std::max(size, static_cast<std::streamsize>(0));
+    if(size <= 0)
+    {
+        f_eof = true;
+        return false;
+    }
+    return true;
+}
+
+
+/** \brief Convert the next block of data.
+ *
+ * \exception invalid_utf16
+ * The data includes an invalid surrogate or is truncated.
+ *
+ * \return The next character or EOF.
+ */
+utf16_istreambuf::int_type utf16_istreambuf::underflow()
+{
+    if(gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    for(;;)
+    {
+        if(!f_eof
+        && static_cast<std::size_t>(f_end - f_next) < UTF16_BLOCK_SIZE / 2)
+        {
+            fill_input();
+        }
+        if(f_next == f_end)
+        {
+            return traits_type::eof();
+        }
+
+        // convert one block at most so the output buffer is large enough
+        //
+        char const * const end(f_next + std::min(static_cast<std::size_t>(f_end - f_next), UTF16_BLOCK_SIZE));
+        char * out(f_output.data());
+        bool truncated(false);
+        char const * const stop(convert_utf16(f_next, end, f_big_endian, out, truncated));
+        f_offset += stop - f_next;
+        f_next = stop;
+        if(stop != end)
+        {
+            if(!truncated)
+            {
+                throw invalid_utf16(
+                          "invalid UTF-16 surrogate found at byte offset "
+                        + std::to_string(f_offset)
+                        + '.');
+            }
+            if(f_eof
+            && end == f_end)
+            {
+                throw invalid_utf16("the UTF-16 data ends in the middle of a character.");
+            }
+        }
+
+        if(out != f_output.data())
+        {
+            setg(f_output.data(), f_output.data(), out);
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+}
+
+
+/** \brief Read and convert UTF-16 data from a stream.
+ *
+ * \param[in] in  The stream with the UTF-16 data.
+ */
+utf16_istream::utf16_istream(std::istream & in)
+    : std::istream(nullptr)
+    , f_buffer(in)
+{
+    rdbuf(&f_buffer);
+}
+
+
+/** \brief Convert UTF-16 data from a buffer.
+ *
+ * \param[in] data  The UTF-16 data.
+ * \param[in] size  The number of bytes in \p data.
+ */
+utf16_istream::utf16_istream(char const * data, std::size_t size)
+    : std::istream(nullptr)
+    , f_buffer(data, size)
+{
+    rdbuf(&f_buffer);
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,88 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief UTF-16 XML streams.
+ *
+ * The utf16_istream converts UTF-16 data to UTF-8 as it gets read. It
+ * can be used to give UTF-16 XML to the parser, which only accepts
+ * UTF-8. The xml object and the other buffer based loaders detect a
+ * UTF-16 byte order mark and use the utf16_istream automatically.
+ */
+
+// C++
+//
+#include    <istream>
+#include    <streambuf>
+#include    <vector>
+
+
+
+namespace basic_xml
+{
+
+
+
+bool                                is_utf16(char const * data, std::size_t size);
+
+
+class utf16_istreambuf
+    : public std::streambuf
+{
+public:
+                                    utf16_istreambuf(std::istream & in);
+                                    utf16_istreambuf(char const * data, std::size_t size);
+                                    utf16_istreambuf(utf16_istreambuf const &) = delete;
+
+    utf16_istreambuf &              operator = (utf16_istreambuf const &) = delete;
+
+protected:
+    virtual int_type                underflow() override;
+
+private:
+    void                            read_byte_order_mark(char const * bom, std::size_t size);
+    bool                            fill_input();
+
+    std::istream *                  f_in = nullptr;
+    char const *                    f_next = nullptr;
+    char const *                    f_end = nullptr;
+    std::size_t                     f_offset = 2;
+    bool                            f_big_endian = false;
+    bool                            f_eof = false;
+    std::vector<char>               f_input = std::vector<char>();
+    std::vector<char>               f_output = std::vector<char>();
+};
+
+
+class utf16_istream
+    : public std::istream
+{
+public:
+                                    utf16_istream(std::istream & in);
+                                    utf16_istream(char const * data, std::size_t size);
+
+private:
+    utf16_istreambuf                f_buffer;
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,142 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the validation functions.
+ *
+ * The validation uses the parser with a handler which does not save
+ * anything. The parser already verifies that the tags match using its
+ * stack of tag names, so there is no need for a tree of nodes.
+ *
+ * The handler only has to verify what the nodes verify when the tree
+ * gets created: the names of the attributes must be valid tokens. That
+ * way a document accepted by validate() is also accepted by the xml
+ * object.
+ */
+
+// self
+//
+#include    "basic-xml/validate.h"
+
+#include    "basic-xml/exception.h"
+#include    "basic-xml/handler.h"
+#include    "basic-xml/mapped_file.h"
+#include    "basic-xml/parser.h"
+#include    "basic-xml/type.h"
+
+
+// snapdev
+//
+#include    <snapdev/not_used.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+class validator
+    : public handler
+{
+public:
+    virtual void                    attribute(std::string_view name, std::string_view value) override;
+};
+
+
+void validator::attribute(std::string_view name, std::string_view value)
+{
+    snapdev::NOT_USED(value);
+
+    if(!is_token(name.data(), name.length()))
+    {
+        throw invalid_token("\"" + std::string(name) + "\" is not a valid token for an attribute name.");
+    }
+}
+
+
+
+} // no name namespace
+
+
+
+/** \brief Verify that an XML file is well formed.
+ *
+ * The file is parsed as with the xml object but no node gets created.
+ * The function returns if the file is valid. Otherwise it throws the
+ * same exception as the xml object would.
+ *
+ * The entities are decoded so errors in them get detected even though
+ * the values are not used.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \param[in] filename  The name of the file to validate.
+ * \param[in] options  The limits used while parsing the file.
+ */
+void validate(std::string const & filename, parse_options const & options)
+{
+    mapped_file const in(filename);
+    validator v;
+    parser p(filename, in.data(), in.size(), v, options);
+    p.parse();
+}
+
+
+/** \brief Verify that an XML stream is well formed.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ * \param[in] options  The limits used while parsing the stream.
+ */
+void validate(std::string const & filename, std::istream & in, parse_options const & options)
+{
+    validator v;
+    parser p(filename, in, v, options);
+    p.parse();
+}
+
+
+/** \brief Verify that XML found in memory is well formed.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] data  The XML to verify.
+ * \param[in] options  The limits used while parsing the data.
+ */
+void validate(std::string const & filename, std::string_view data, parse_options const & options)
+{
+    validator v;
+    parser p(filename, data.data(), data.length(), v, options);
+    p.parse();
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,55 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Verify that an XML document is well formed.
+ *
+ * The validate() functions run the parser without creating any node.
+ * They are much faster than loading an xml object when you only want
+ * to know whether a document is valid (i.e. to lint configuration
+ * files).
+ */
+
+// self
+//
+#include    <basic-xml/parse_options.h>
+
+
+// C++
+//
+#include    <istream>
+#include    <string>
+#include    <string_view>
+
+
+
+namespace basic_xml
+{
+
+
+
+void                                validate(std::string const & filename, parse_options const & options = parse_options());
+void                                validate(std::string const & filename, std::istream & in, parse_options const & options = parse_options());
+void                                validate(std::string const & filename, std::string_view data, parse_options const & options = parse_options());
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,313 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+/** \file
+ * \brief Implementation of the watcher.
+ *
+ * The watcher uses inotify on the directory of the file instead of the
+ * file itself. Many tools (editors, package managers, configuration
+ * management systems) save a file by writing a new file and renaming it
+ * over the old one. A watch on the file would then keep watching the
+ * old inode. On the directory, we see both, a file written in place
+ * (IN_CLOSE_WRITE) and a file renamed over the old one (IN_MOVED_TO).
+ *
+ * The root is saved in a shared pointer which gets replaced with the
+ * atomic shared pointer functions. A reader gets the current root
+ * without waiting for a parse to end and keeps it alive as long as it
+ * holds it. The old tree gets released once the last reader drops it.
+ */
+
+// self
+//
+#include    "basic-xml/watcher.h"
+
+#include    "basic-xml/exception.h"
+#include    "basic-xml/xml.h"
+
+
+// C++
+//
+#include    <filesystem>
+
+
+// C
+//
+#include    <poll.h>
+#include    <string.h>
+#include    <sys/eventfd.h>
+#include    <sys/inotify.h>
+#include    <unistd.h>
+
+
+// last include
+//
+#include    <snapdev/poison.h>
+
+
+
+namespace basic_xml
+{
+
+
+
+namespace
+{
+
+
+
+/** \brief Size of the buffer used to read the inotify events.
+ *
+ * Each event is at least 16 bytes plus the name of the file. This is
+ * enough for many events at once.
+ */
+constexpr std::size_t const     EVENT_BUFFER_SIZE = 16 * 1024;
+
+
+
+} // no name namespace
+
+
+
+/** \brief Load a file and watch it for changes.
+ *
+ * The constructor loads the file immediately. If that fails, it throws
+ * the parser exception and no thread gets created.
+ *
+ * Later, each time the file changes, it gets parsed again by a thread.
+ * If the new version is not valid, the previous tree remains current
+ * and the \p callback function gets called with the error message. The
+ * callback is called from the watcher thread and must not throw.
+ *
+ * The trees are shared between threads so the entities are always
+ * decoded while parsing (the lazy mode modifies the nodes on their
+ * first access).
+ *
+ * \exception io_error
+ * The inotify watch could not be created.
+ *
+ * \param[in] filename  The name of the XML file to load and watch.
+ * \param[in] callback  The function called when a new version of the
+ * file cannot be loaded.
+ * \param[in] options  The options used to parse the file.
+ */
+watcher::watcher(
+          std::string const & filename
+        , error_callback_t callback
+        , parse_options const & options)
+    : f_filename(filename)
+    , f_callback(callback)
+    , f_options(options)
+{
+    f_options.f_decode = decode_t::DECODE_NOW;
+
+    std::filesystem::path const path(filename);
+    f_basename = path.filename();
+    std::string directory(path.parent_path());
+    if(directory.empty())
+    {
+        directory = ".";
+    }
+
+    // create the watch first so a change made while we load the file
+    // is not missed
+    //
+    f_inotify.reset(inotify_init1(IN_NONBLOCK | IN_CLOEXEC));
+    if(f_inotify == nullptr)
+    {
+        int const e(errno);
+        throw io_error("could not initialize inotify: " + std::string(strerror(e)) + ".");
+    }
+    if(inotify_add_watch(f_inotify.get(), directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        int const e(errno);
+        throw io_error("could not watch directory \""
+                     + directory
+                     + "\": " + strerror(e) + ".");
+    }
+    f_stop.reset(eventfd(0, EFD_CLOEXEC));
+    if(f_stop == nullptr)
+    {
+        int const e(errno);
+        throw io_error("could not create an eventfd: " + std::string(strerror(e)) + ".");
+    }
+
+    xml x(f_filename, f_options);
+    f_root = x.root();
+
+    f_thread = std::thread(&watcher::run, this);
+}
+
+
+/** \brief Stop watching the file.
+ *
+ * The destructor stops the thread and waits for it. If the thread is
+ * parsing the file, that parsing ends first.
+ *
+ * The trees returned by root() remain valid.
+ */
+watcher::~watcher()
+{
+    std::uint64_t const stop(1);
+    if(write(f_stop.get(), &stop, sizeof(stop)) != sizeof(stop))
+    {
+        // there is no way to stop the thread
+        //
+        std::terminate();
+    }
+    f_thread.join();
+}
+
+
+/** \brief Get the current root.
+ *
+ * This function never waits for a parse to end. It returns the last
+ * valid version of the file. The tree is shared with the other readers
+ * and must not be modified.
+ *
+ * \return The root of the current version of the file.
+ */
+node::pointer_t watcher::root() const
+{
+    return std::atomic_load(&f_root);
+}
+
+
+/** \brief Get the version of the current root.
+ *
+ * The version starts at 1 and is incremented each time a new tree
+ * replaces the current one. Changes which fail to load do not change
+ * the version.
+ *
+ * \return The version of the current root.
+ */
+std::uint64_t watcher::version() const
+{
+    return f_version;
+}
+
+
+/** \brief Wait for changes and reload the file.
+ *
+ * This function runs in the watcher thread. It waits for inotify events
+ * and for the stop signal sent by the destructor. All the events read
+ * at once trigger at most one reload.
+ *
+ * When the kernel event queue overflows, the events which were lost may
+ * include a change of the file so it gets reloaded. When the directory
+ * is removed or unmounted, the watch is gone; the error callback gets
+ * called and the thread stops. The last tree loaded remains available.
+ */
+void watcher::run()
+{
+    alignas(inotify_event) char buffer[EVENT_BUFFER_SIZE];
+    pollfd fds[2] =
+    {
+        { f_inotify.get(), POLLIN, 0 },
+        { f_stop.get(), POLLIN, 0 },
+    };
+    for(;;)
+    {
+        if(poll(fds, 2, -1) < 0)
+        {
+            int const e(errno);
+            if(e == EINTR)
+            {
+                continue;
+            }
+            if(f_callback != nullptr)
+            {
+                f_callback(f_filename, "poll() failed: " + std::string(strerror(e)) + "; the file is not watched anymore.");
+            }
+            return;
+        }
+        if(fds[1].revents != 0)
+        {
+            return;
+        }
+        if((fds[0].revents & POLLIN) == 0)
+        {
+            continue;
+        }
+
+        bool changed(false);
+        bool ignored(false);
+        for(;;)
+        {
+            ssize_t const size(read(f_inotify.get(), buffer, sizeof(buffer)));
+            if(size <= 0)
+            {
+                break;
+            }
+            for(char const * p(buffer); p < buffer + size; )
+            {
+                inotify_event const * event(reinterpret_cast<inotify_event const *>(p));
+                if((event->mask & IN_Q_OVERFLOW) != 0
+                || (event->len > 0
+                    && f_basename == event->name))
+                {
+                    changed = true;
+                }
+                if((event->mask & IN_IGNORED) != 0)
+                {
+                    ignored = true;
+                }
+                p += sizeof(inotify_event) + event->len;
+            }
+        }
+        if(changed)
+        {
+            reload();
+        }
+        if(ignored)
+        {
+            if(f_callback != nullptr)
+            {
+                f_callback(f_filename, "the directory was removed or unmounted; the file is not watched anymore.");
+            }
+            return;
+        }
+    }
+}
+
+
+/** \brief Load the new version of the file.
+ *
+ * On success, the new tree replaces the current one. On failure, the
+ * current tree remains and the error callback gets called.
+ */
+void watcher::reload()
+{
+    try
+    {
+        xml x(f_filename, f_options);
+        std::atomic_store(&f_root, x.root());
+        ++f_version;
+    }
+    catch(std::exception const & e)
+    {
+        if(f_callback != nullptr)
+        {
+            f_callback(f_filename, e.what());
+        }
+    }
+}
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
@@ -0,0 +1,91 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+#pragma once
+
+
+/** \file
+ * \brief Reload an XML file each time it changes.
+ *
+ * The watcher object loads an XML file and then watches it with inotify.
+ * When the file changes, a background thread parses it again and the
+ * new tree replaces the old one without blocking the readers.
+ */
+
+// self
+//
+#include    <basic-xml/node.h>
+#include    <basic-xml/parse_options.h>
+
+
+// snapdev
+//
+#include    <snapdev/raii_generic_deleter.h>
+
+
+// C++
+//
+#include    <atomic>
+#include    <cstdint>
+#include    <functional>
+#include    <string>
+#include    <thread>
+
+
+
+namespace basic_xml
+{
+
+
+
+class watcher
+{
+public:
+    typedef std::function<void(std::string const & filename, std::string const & message)>
+                                    error_callback_t;
+
+                                    watcher(
+                                              std::string const & filename
+                                            , error_callback_t callback = error_callback_t()
+                                            , parse_options const & options = parse_options());
+                                    watcher(watcher const &) = delete;
+                                    ~watcher();
+
+    watcher &                       operator = (watcher const &) = delete;
+
+    node::pointer_t                 root() const;
+    std::uint64_t                   version() const;
+
+private:
+    void                            run();
+    void                            reload();
+
+    std::string const               f_filename;
+    std::string                     f_basename = std::string();
+    error_callback_t                f_callback = error_callback_t();
+    parse_options                   f_options = parse_options();
+    node::pointer_t                 f_root = node::pointer_t();
+    std::atomic<std::uint64_t>      f_version = 1;
+    snapdev::raii_fd_t              f_inotify = snapdev::raii_fd_t();
+    snapdev::raii_fd_t              f_stop = snapdev::raii_fd_t();
+    std::thread                     f_thread = std::thread();
+};
+
+
+
+} // namespace basic_xml
+// vim: ts=4 sw=4 et
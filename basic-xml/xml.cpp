@@ -29,17 +29,10 @@
 #include    "basic-xml/xml.h"
 
 #include    "basic-xml/exception.h"
+#include    "basic-xml/mapped_file.h"
+#include    "basic-xml/parallel_parser.h"
 #include    "basic-xml/parser.h"
 
-// C++
-//
-#include    <fstream>
-
-
-// C
-//
-#include    <string.h>
-
 
 // last include
 //
@@ -104,8 +97,10 @@
  * you need to create the correct file from the start.
  *
  * \warning
- * The library reads the entire file in memory. It is not expected to be
- * used to stream XML data.
+ * The xml object reads the entire file in memory. To go through very
+ * large files, use the child_reader to get the children of the root tag
+ * one at a time, the reader to walk the elements without creating any
+ * node, or a handler to receive the parser events.
  */
 
 
@@ -114,24 +109,156 @@ namespace basic_xml
 
 
 
-xml::xml(std::string const & filename)
+namespace
+{
+
+
+
+/** \brief Get the default options with the specified decode mode.
+ *
+ * \param[in] decode  Whether to decode the entities now or on the first
+ * access to the nodes.
+ *
+ * \return The parse options.
+ */
+parse_options decode_options(decode_t decode)
+{
+    parse_options options;
+    options.f_decode = decode;
+    return options;
+}
+
+
+
+} // no name namespace
+
+
+
+/** \brief Load an XML file.
+ *
+ * This constructor memory maps the specified file and parses it. When the
+ * file cannot be mapped (i.e. a pipe), it gets read in memory first.
+ *
+ * In lazy mode, the entities found in the text and attribute values
+ * get decoded on the first access to each node instead of while parsing.
+ * This is faster when most of the attributes are never read. Note that
+ * in that case, an invalid entity gets reported on the first access to
+ * the node and not by the constructor.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \param[in] filename  The name of the file to load.
+ * \param[in] decode  Whether to decode the entities now or on the first
+ * access to the nodes.
+ */
+xml::xml(std::string const & filename, decode_t decode)
+    : xml(filename, decode_options(decode))
+{
+}
+
+
+/** \brief Load XML from a stream.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ * \param[in] decode  Whether to decode the entities now or on the first
+ * access to the nodes.
+ */
+xml::xml(std::string const & filename, std::istream & in, decode_t decode)
+    : xml(filename, in, decode_options(decode))
 {
-    std::ifstream in(filename);
-    if(!in.is_open())
-    {
-        int const e(errno);
-        throw file_not_found("could not open XML file \""
-                           + filename
-                           + "\": " + strerror(e) + ".");
-    }
-
-    parser p(filename, in, f_root);
 }
 
 
-xml::xml(std::string const & filename, std::istream & in)
+/** \brief Load an XML file with limits.
+ *
+ * This constructor works like the one accepting a decode mode. The
+ * \p options also define limits such as the maximum nesting depth or
+ * the maximum number of nodes. Use those when the file comes from a
+ * source which you do not trust.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \exception limit_exceeded
+ * The file is over one of the limits defined in \p options.
+ *
+ * \param[in] filename  The name of the file to load.
+ * \param[in] options  The options used to parse the file.
+ */
+xml::xml(std::string const & filename, parse_options const & options)
+{
+    mapped_file const in(filename);
+    parser p(filename, in.data(), in.size(), f_root, options);
+}
+
+
+/** \brief Load XML from a stream with limits.
+ *
+ * \exception limit_exceeded
+ * The input is over one of the limits defined in \p options.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] in  The stream to read the XML from.
+ * \param[in] options  The options used to parse the stream.
+ */
+xml::xml(std::string const & filename, std::istream & in, parse_options const & options)
+{
+    parser p(filename, in, f_root, options);
+}
+
+
+/** \brief Load XML found in memory.
+ *
+ * This constructor parses the bytes of \p data in place. There is no
+ * need to wrap a string or a network buffer in an std::istringstream,
+ * which would copy the data and go through the stream for each block.
+ * This is as fast as loading a memory mapped file.
+ *
+ * The data must remain valid until the constructor returns. The tree
+ * does not reference it afterward. If the data starts with a gzip
+ * header, it gets decompressed while parsed.
+ *
+ * \exception limit_exceeded
+ * The input is over one of the limits defined in \p options.
+ *
+ * \param[in] filename  The name used in error messages.
+ * \param[in] data  The XML to parse.
+ * \param[in] options  The options used to parse the data.
+ */
+xml::xml(std::string const & filename, std::string_view data, parse_options const & options)
+{
+    parser p(filename, data.data(), data.length(), f_root, options);
+}
+
+
+/** \brief Load a large XML file using several threads.
+ *
+ * This constructor works like the one loading a file, except that the
+ * content of the root tag gets parsed by up to \p thread_count threads.
+ * This is only useful with very large files with many children under
+ * the root tag. Small files are parsed in the current thread.
+ *
+ * The resulting tree and the errors are the same as with the other
+ * constructors.
+ *
+ * \warning
+ * This constructor does not accept parse_options. The chunks are parsed
+ * separately so limits such as the total number of nodes cannot be
+ * enforced. Only use it with files which come from a trusted source.
+ *
+ * \exception file_not_found
+ * The file could not be opened.
+ *
+ * \param[in] filename  The name of the file to load.
+ * \param[in] thread_count  The maximum number of threads to use, 0 means
+ * one per CPU.
+ */
+xml::xml(std::string const & filename, std::size_t thread_count)
 {
-    parser p(filename, in, f_root);
+    mapped_file const in(filename);
+    parallel_parser p(filename, in.data(), in.size(), f_root, thread_count);
 }
 
 
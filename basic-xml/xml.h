@@ -29,6 +29,12 @@
 // self
 //
 #include    <basic-xml/node.h>
+#include    <basic-xml/parse_options.h>
+
+
+// C++
+//
+#include    <string_view>
 
 
 
@@ -44,8 +50,12 @@ public:
     typedef std::map<std::string, pointer_t>
                                     map_t;
 
-                                    xml(std::string const & filename);
-                                    xml(std::string const & filename, std::istream & in);
+                                    xml(std::string const & filename, decode_t decode = decode_t::DECODE_NOW);
+                                    xml(std::string const & filename, std::istream & in, decode_t decode = decode_t::DECODE_NOW);
+                                    xml(std::string const & filename, parse_options const & options);
+                                    xml(std::string const & filename, std::istream & in, parse_options const & options);
+                                    xml(std::string const & filename, std::string_view data, parse_options const & options = parse_options());
+                                    xml(std::string const & filename, std::size_t thread_count);
 
     node::pointer_t                 root();
 
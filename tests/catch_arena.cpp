@@ -0,0 +1,152 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/arena.h>
+
+#include    <basic-xml/xml.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <cstdint>
+
+
+
+namespace
+{
+
+
+
+std::string const g_document(
+        "<?xml version=\"1.0\"?>\n"
+        "<catalog version=\"3\">\n"
+        "  <book id=\"b1\" lang=\"en\"><title>XML &amp; You</title><price currency=\"USD\">12.50</price></book>\n"
+        "  <book id=\"b2\" lang=\"fr\"><title>Le &lt;XML&gt;</title><price currency=\"EUR\">9.99</price></book>\n"
+        "  <note>a longer piece of text which does not fit in a small string buffer</note>\n"
+        "</catalog>\n");
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("arena", "[arena][valid]")
+{
+    CATCH_START_SECTION("arena: allocate from blocks")
+    {
+        basic_xml::arena a;
+        CATCH_REQUIRE(a.allocated() == 0);
+
+        void * p(a.allocate(100, 8));
+        CATCH_REQUIRE(p != nullptr);
+        CATCH_REQUIRE(reinterpret_cast<std::uintptr_t>(p) % 8 == 0);
+        void * q(a.allocate(24, 16));
+        CATCH_REQUIRE(reinterpret_cast<std::uintptr_t>(q) % 16 == 0);
+        CATCH_REQUIRE(a.allocated() == 124);
+
+        // memory given back is not reused
+        //
+        a.deallocate(q, 24, 16);
+        CATCH_REQUIRE(a.allocated() == 124);
+
+        basic_xml::arena b;
+        CATCH_REQUIRE(a.is_equal(a));
+        CATCH_REQUIRE_FALSE(a.is_equal(b));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("arena: same tree as the heap")
+    {
+        for(auto const decode : { basic_xml::decode_t::DECODE_NOW, basic_xml::decode_t::DECODE_LAZY })
+        {
+            basic_xml::parse_options heap_options;
+            heap_options.f_decode = decode;
+            basic_xml::xml heap("catalog.xml", std::string_view(g_document), heap_options);
+
+            basic_xml::parse_options arena_options;
+            arena_options.f_decode = decode;
+            arena_options.f_use_arena = true;
+            basic_xml::xml x("catalog.xml", std::string_view(g_document), arena_options);
+
+            CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(x.root()) == SNAP_CATCH2_NAMESPACE::to_string(heap.root()));
+
+            basic_xml::node::pointer_t const book(x.root()->first_child());
+            CATCH_REQUIRE(book->attribute("id") == "b1");
+            CATCH_REQUIRE(book->first_child()->text() == "XML & You");
+            CATCH_REQUIRE(book->next()->first_child()->text() == "Le <XML>");
+            CATCH_REQUIRE(book->all_attributes() == heap.root()->first_child()->all_attributes());
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("arena: nodes remain valid after the document is gone")
+    {
+        basic_xml::parse_options options;
+        options.f_use_arena = true;
+        basic_xml::node::pointer_t note;
+        {
+            basic_xml::xml x("catalog.xml", std::string_view(g_document), options);
+            note = x.root()->last_child();
+        }
+        CATCH_REQUIRE(note->tag_name() == "note");
+        CATCH_REQUIRE(note->text() == "a longer piece of text which does not fit in a small string buffer");
+        CATCH_REQUIRE(note->parent() == nullptr);
+
+        // the node can still be modified
+        //
+        note->set_attribute("priority", "a value long enough to be allocated from the arena");
+        note->append_text(" and more text");
+        CATCH_REQUIRE(note->attribute("priority") == "a value long enough to be allocated from the arena");
+        CATCH_REQUIRE(note->text() == "a longer piece of text which does not fit in a small string buffer and more text");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("arena: allocate nodes by hand")
+    {
+        basic_xml::arena::pointer_t a(std::make_shared<basic_xml::arena>());
+        basic_xml::node::pointer_t root(std::allocate_shared<basic_xml::node>(
+                  basic_xml::arena_allocator<basic_xml::node>(a)
+                , "root"
+                , a.get()));
+        root->set_text("some text long enough to not fit in the string itself");
+        root->set_attribute("name", "value");
+        CATCH_REQUIRE(a->allocated() > sizeof(basic_xml::node));
+
+        // the nodes keep the arena alive
+        //
+        std::weak_ptr<basic_xml::arena> weak(a);
+        a.reset();
+        CATCH_REQUIRE_FALSE(weak.expired());
+        CATCH_REQUIRE(root->text() == "some text long enough to not fit in the string itself");
+        root.reset();
+        CATCH_REQUIRE(weak.expired());
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
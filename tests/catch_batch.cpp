@@ -0,0 +1,210 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/batch.h>
+
+#include    <basic-xml/exception.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <filesystem>
+#include    <fstream>
+
+
+
+namespace
+{
+
+
+
+std::string create_batch_folder(std::string const & name, std::size_t count)
+{
+    std::string const path(SNAP_CATCH2_NAMESPACE::get_folder_name() + "/" + name);
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+
+    for(std::size_t idx(0); idx < count; ++idx)
+    {
+        std::ofstream f;
+        f.open(path + "/table-" + std::to_string(idx) + ".xml");
+        CATCH_REQUIRE(f.is_open());
+        f << "<?xml version=\"1.0\"?>\n"
+             "<table name=\"t" << idx << "\">\n"
+             "  <column name=\"id\" type=\"uint64\"/>\n"
+             "  <column name=\"value\">" << idx * 3 << "</column>\n"
+             "</table>\n";
+    }
+
+    // a file which does not match the extension is ignored
+    //
+    {
+        std::ofstream f;
+        f.open(path + "/README.txt");
+        CATCH_REQUIRE(f.is_open());
+        f << "not XML\n";
+    }
+
+    return path;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("batch", "[batch][valid][thread]")
+{
+    CATCH_START_SECTION("batch: load a directory")
+    {
+        std::string const path(create_batch_folder("batch", 50));
+
+        for(std::size_t thread_count : { 0, 1, 4, 100 })
+        {
+            basic_xml::batch b(thread_count);
+            b.add_directory(path);
+            b.load();
+
+            CATCH_REQUIRE(b.errors().empty());
+            CATCH_REQUIRE(b.documents().size() == 50);
+            for(std::size_t idx(0); idx < 50; ++idx)
+            {
+                std::string const filename(path + "/table-" + std::to_string(idx) + ".xml");
+                auto it(b.documents().find(filename));
+                CATCH_REQUIRE(it != b.documents().end());
+                basic_xml::node::pointer_t root(it->second->root());
+                CATCH_REQUIRE(root != nullptr);
+                CATCH_REQUIRE(root->tag_name() == "table");
+                CATCH_REQUIRE(root->attribute("name") == "t" + std::to_string(idx));
+                CATCH_REQUIRE(root->last_child()->text() == std::to_string(idx * 3));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("batch: load files")
+    {
+        std::string const path(create_batch_folder("batch-files", 3));
+
+        basic_xml::batch b(2);
+        b.add_file(path + "/table-2.xml");
+        b.add_file(path + "/table-0.xml");
+        b.add_file(path + "/table-2.xml");
+        b.load();
+
+        CATCH_REQUIRE(b.errors().empty());
+        CATCH_REQUIRE(b.documents().size() == 2);
+        CATCH_REQUIRE(b.documents().count(path + "/table-0.xml") == 1);
+        CATCH_REQUIRE(b.documents().count(path + "/table-1.xml") == 0);
+        CATCH_REQUIRE(b.documents().count(path + "/table-2.xml") == 1);
+
+        // loading again gives the same result
+        //
+        b.load();
+        CATCH_REQUIRE(b.errors().empty());
+        CATCH_REQUIRE(b.documents().size() == 2);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("batch: empty batch")
+    {
+        basic_xml::batch b;
+        b.load();
+        CATCH_REQUIRE(b.documents().empty());
+        CATCH_REQUIRE(b.errors().empty());
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("batch_errors", "[batch][invalid][thread]")
+{
+    CATCH_START_SECTION("batch_errors: errors are saved per file")
+    {
+        std::string const path(create_batch_folder("batch-errors", 10));
+
+        std::string const invalid(path + "/table-4.xml");
+        {
+            std::ofstream f;
+            f.open(invalid);
+            CATCH_REQUIRE(f.is_open());
+            f << "<table>\n"
+                 "  <column name='id'>\n"
+                 "</table>\n";
+        }
+        std::string const missing(path + "/missing.xml");
+
+        basic_xml::batch b(4);
+        b.add_directory(path);
+        b.add_file(missing);
+        b.load();
+
+        CATCH_REQUIRE(b.documents().size() == 9);
+        CATCH_REQUIRE(b.documents().count(invalid) == 0);
+        CATCH_REQUIRE(b.errors().size() == 2);
+
+        std::string message;
+        try
+        {
+            basic_xml::xml x(invalid);
+        }
+        catch(basic_xml::xml_error const & e)
+        {
+            message = e.what();
+        }
+        CATCH_REQUIRE_FALSE(message.empty());
+        CATCH_REQUIRE(b.errors().at(invalid) == message);
+
+        CATCH_REQUIRE(b.errors().at(missing)
+                == "xml_error: could not open XML file \""
+                 + missing
+                 + "\": "
+                 + strerror(ENOENT)
+                 + ".");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("batch_errors: missing directory")
+    {
+        std::string const path(SNAP_CATCH2_NAMESPACE::get_folder_name() + "/batch-does-not-exist");
+
+        basic_xml::batch b;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  b.add_directory(path)
+                , basic_xml::file_not_found
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: could not read XML directory \""
+                        + path
+                        + "\": "
+                        + strerror(ENOENT)
+                        + ".", true));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
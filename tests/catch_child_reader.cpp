@@ -0,0 +1,162 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/child_reader.h>
+
+#include    <basic-xml/exception.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <fstream>
+#include    <sstream>
+
+
+
+CATCH_TEST_CASE("child_reader", "[child_reader][valid]")
+{
+    CATCH_START_SECTION("child_reader: read records one at a time")
+    {
+        std::stringstream ss;
+        ss << "<?xml version=\"1.0\"?>\n"
+              "<records count='3'>\n"
+              "  <record id='1'><name>One</name></record>\n"
+              "  <!-- the second one is empty -->\n"
+              "  <record id='2'/>\n"
+              "  <record id='3'><name>Three &amp; more</name><tags><tag>a</tag><tag>b</tag></tags></record>\n"
+              "</records>\n";
+
+        basic_xml::child_reader r("records.xml", ss);
+
+        basic_xml::node::pointer_t root(r.root());
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->tag_name() == "records");
+        CATCH_REQUIRE(root->attribute("count") == "3");
+
+        basic_xml::node::pointer_t record(r.next());
+        CATCH_REQUIRE(record != nullptr);
+        CATCH_REQUIRE(record->tag_name() == "record");
+        CATCH_REQUIRE(record->attribute("id") == "1");
+        CATCH_REQUIRE(record->parent() == nullptr);
+        CATCH_REQUIRE(record->first_child()->tag_name() == "name");
+        CATCH_REQUIRE(record->first_child()->text() == "One");
+
+        // once released, the previous record is gone
+        //
+        std::weak_ptr<basic_xml::node> previous(record);
+        record = r.next();
+        CATCH_REQUIRE(previous.expired());
+        CATCH_REQUIRE(record != nullptr);
+        CATCH_REQUIRE(record->attribute("id") == "2");
+        CATCH_REQUIRE(record->first_child() == nullptr);
+
+        record = r.next();
+        CATCH_REQUIRE(record != nullptr);
+        CATCH_REQUIRE(record->attribute("id") == "3");
+        CATCH_REQUIRE(record->first_child()->text() == "Three & more");
+        basic_xml::node::pointer_t tags(record->first_child()->next());
+        CATCH_REQUIRE(tags->tag_name() == "tags");
+        CATCH_REQUIRE(tags->first_child()->text() == "a");
+        CATCH_REQUIRE(tags->last_child()->text() == "b");
+
+        CATCH_REQUIRE(r.next() == nullptr);
+        CATCH_REQUIRE(r.next() == nullptr);
+
+        // the root never gets any children nor the spaces between them
+        //
+        CATCH_REQUIRE(root->first_child() == nullptr);
+        CATCH_REQUIRE(root->text(false).empty());
+        CATCH_REQUIRE(r.root() == root);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("child_reader: root without children, from a file")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/no-children.xml");
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << "<lonely name='root'>just text</lonely>";
+        }
+
+        basic_xml::child_reader r(filename);
+        CATCH_REQUIRE(r.next() == nullptr);
+        CATCH_REQUIRE(r.root()->tag_name() == "lonely");
+        CATCH_REQUIRE(r.root()->text() == "just text");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("child_reader: many records from a buffer")
+    {
+        std::string doc("<table>");
+        for(int idx(0); idx < 1000; ++idx)
+        {
+            doc += "<row n=\"" + std::to_string(idx) + "\"><v>" + std::to_string(idx * 2) + "</v></row>";
+        }
+        doc += "</table>";
+
+        basic_xml::child_reader r("table.xml", doc.data(), doc.length());
+        int count(0);
+        for(basic_xml::node::pointer_t row(r.next()); row != nullptr; row = r.next())
+        {
+            CATCH_REQUIRE(row->attribute("n") == std::to_string(count));
+            CATCH_REQUIRE(row->first_child()->text() == std::to_string(count * 2));
+            ++count;
+        }
+        CATCH_REQUIRE(count == 1000);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("child_reader_errors", "[child_reader][invalid]")
+{
+    CATCH_START_SECTION("child_reader_errors: error in a later record")
+    {
+        std::stringstream ss;
+        std::string const filename("bad-record.xml");
+        ss << "<records>\n"
+              "<record id='1'/>\n"
+              "<record id='2'><name>Two</nome></record>\n"
+              "</records>\n";
+
+        basic_xml::child_reader r(filename, ss);
+        CATCH_REQUIRE(r.next()->attribute("id") == "1");
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  r.next()
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":3:32: unexpected token \"nome\" in this closing tag; expected \"name\" instead."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,242 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/document_cache.h>
+
+#include    <basic-xml/exception.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <atomic>
+#include    <filesystem>
+#include    <thread>
+
+
+
+namespace
+{
+
+
+
+std::string cache_path()
+{
+    std::string const path(SNAP_CATCH2_NAMESPACE::get_folder_name() + "/cache");
+    std::filesystem::create_directories(path);
+    return path;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("document_cache", "[cache][valid]")
+{
+    CATCH_START_SECTION("document_cache: second load is a hit")
+    {
+        std::string const filename(cache_path() + "/hit.xml");
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>1</value></config>");
+
+        basic_xml::document_cache cache;
+        CATCH_REQUIRE(cache.max_documents() == 0);
+        basic_xml::node::pointer_t const first(cache.load(filename));
+        CATCH_REQUIRE(first->tag_name() == "config");
+        CATCH_REQUIRE(cache.hits() == 0);
+        CATCH_REQUIRE(cache.misses() == 1);
+
+        basic_xml::node::pointer_t const second(cache.load(filename));
+        CATCH_REQUIRE(second == first);
+        CATCH_REQUIRE(cache.hits() == 1);
+        CATCH_REQUIRE(cache.misses() == 1);
+        CATCH_REQUIRE(cache.size() == 1);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("document_cache: a modified file gets parsed again")
+    {
+        std::string const filename(cache_path() + "/modified.xml");
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>1</value></config>");
+
+        basic_xml::document_cache cache;
+        basic_xml::node::pointer_t const first(cache.load(filename));
+        CATCH_REQUIRE(first->first_child()->text() == "1");
+
+        // same size, only the modification time changes
+        //
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>2</value></config>");
+        std::filesystem::last_write_time(
+                  filename
+                , std::filesystem::last_write_time(filename) + std::chrono::seconds(10));
+        basic_xml::node::pointer_t const second(cache.load(filename));
+        CATCH_REQUIRE(second != first);
+        CATCH_REQUIRE(second->first_child()->text() == "2");
+        CATCH_REQUIRE(first->first_child()->text() == "1");
+
+        // replaced by a new file with a rename(2); the new inode is
+        // enough even if the size and time are the same
+        //
+        std::string const replacement(cache_path() + "/replacement.xml");
+        SNAP_CATCH2_NAMESPACE::write_file(replacement, "<config><value>3</value></config>");
+        std::filesystem::last_write_time(
+                  replacement
+                , std::filesystem::last_write_time(filename));
+        std::filesystem::rename(replacement, filename);
+        basic_xml::node::pointer_t const third(cache.load(filename));
+        CATCH_REQUIRE(third != second);
+        CATCH_REQUIRE(third->first_child()->text() == "3");
+
+        CATCH_REQUIRE(cache.hits() == 0);
+        CATCH_REQUIRE(cache.misses() == 3);
+        CATCH_REQUIRE(cache.size() == 1);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("document_cache: least recently used documents get evicted")
+    {
+        std::string const path(cache_path());
+        for(int idx(0); idx < 4; ++idx)
+        {
+            SNAP_CATCH2_NAMESPACE::write_file(path + "/lru-" + std::to_string(idx) + ".xml", "<lru id='" + std::to_string(idx) + "'></lru>");
+        }
+
+        basic_xml::document_cache cache(3);
+        CATCH_REQUIRE(cache.max_documents() == 3);
+        cache.load(path + "/lru-0.xml");
+        cache.load(path + "/lru-1.xml");
+        cache.load(path + "/lru-2.xml");
+        cache.load(path + "/lru-0.xml");            // hit, 1 is now the oldest
+        CATCH_REQUIRE(cache.hits() == 1);
+        cache.load(path + "/lru-3.xml");            // evicts 1
+        CATCH_REQUIRE(cache.size() == 3);
+
+        cache.load(path + "/lru-0.xml");
+        cache.load(path + "/lru-2.xml");
+        cache.load(path + "/lru-3.xml");
+        CATCH_REQUIRE(cache.hits() == 4);
+        CATCH_REQUIRE(cache.misses() == 4);
+        cache.load(path + "/lru-1.xml");            // miss, evicts 0
+        CATCH_REQUIRE(cache.misses() == 5);
+        cache.load(path + "/lru-0.xml");
+        CATCH_REQUIRE(cache.misses() == 6);
+
+        // reducing the limit evicts immediately
+        //
+        cache.set_max_documents(1);
+        CATCH_REQUIRE(cache.size() == 1);
+        cache.load(path + "/lru-0.xml");
+        CATCH_REQUIRE(cache.hits() == 5);
+
+        cache.erase(path + "/lru-0.xml");
+        CATCH_REQUIRE(cache.size() == 0);
+        cache.load(path + "/lru-0.xml");
+        CATCH_REQUIRE(cache.misses() == 7);
+        cache.clear();
+        CATCH_REQUIRE(cache.size() == 0);
+        CATCH_REQUIRE(cache.hits() == 5);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("document_cache: many threads share the same trees")
+    {
+        std::string const path(cache_path());
+        for(int idx(0); idx < 8; ++idx)
+        {
+            SNAP_CATCH2_NAMESPACE::write_file(path + "/thread-" + std::to_string(idx) + ".xml", "<thread id='" + std::to_string(idx) + "'>text</thread>");
+        }
+
+        basic_xml::document_cache cache;
+        std::atomic<int> errors(0);
+        std::vector<std::thread> threads;
+        for(int t(0); t < 4; ++t)
+        {
+            threads.emplace_back([&cache, &errors, &path]()
+                {
+                    for(int count(0); count < 100; ++count)
+                    {
+                        int const idx(count % 8);
+                        basic_xml::node::pointer_t const root(cache.load(path + "/thread-" + std::to_string(idx) + ".xml"));
+                        if(root->attribute("id") != std::to_string(idx)
+                        || root->text() != "text")
+                        {
+                            ++errors;
+                        }
+                    }
+                });
+        }
+        for(auto & t : threads)
+        {
+            t.join();
+        }
+        CATCH_REQUIRE(errors == 0);
+        CATCH_REQUIRE(cache.size() == 8);
+        CATCH_REQUIRE(cache.hits() + cache.misses() == 400);
+        CATCH_REQUIRE(cache.misses() >= 8);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("document_cache_errors", "[cache][invalid]")
+{
+    CATCH_START_SECTION("document_cache_errors: file not found")
+    {
+        basic_xml::document_cache cache;
+        CATCH_REQUIRE_THROWS_AS(
+                  cache.load(cache_path() + "/does-not-exist.xml")
+                , basic_xml::file_not_found);
+        CATCH_REQUIRE(cache.size() == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("document_cache_errors: a file which becomes invalid is removed")
+    {
+        std::string const filename(cache_path() + "/invalid.xml");
+        std::string const valid("<config></config>");
+        SNAP_CATCH2_NAMESPACE::write_file(filename, valid);
+
+        basic_xml::document_cache cache;
+        cache.load(filename);
+        CATCH_REQUIRE(cache.size() == 1);
+
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config></wrong>");
+        CATCH_REQUIRE_THROWS_AS(
+                  cache.load(filename)
+                , basic_xml::unexpected_token);
+        CATCH_REQUIRE(cache.size() == 0);
+        CATCH_REQUIRE(cache.misses() == 2);
+
+        std::filesystem::remove(filename);
+        CATCH_REQUIRE_THROWS_AS(
+                  cache.load(filename)
+                , basic_xml::file_not_found);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,266 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/gzip.h>
+
+#include    <basic-xml/child_reader.h>
+#include    <basic-xml/exception.h>
+#include    <basic-xml/xml.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <algorithm>
+#include    <fstream>
+#include    <sstream>
+
+
+
+namespace
+{
+
+
+
+std::string generate_document(std::size_t count)
+{
+    std::stringstream ss;
+    ss << "<?xml version=\"1.0\"?>\n"
+          "<export>\n";
+    for(std::size_t idx(0); idx < count; ++idx)
+    {
+        ss << "  <row id=\"" << idx << "\"><name>Caf\xC3\xA9 &amp; " << idx << "</name></row>\n";
+    }
+    ss << "</export>\n";
+    return ss.str();
+}
+
+
+std::string compress(std::string const & data)
+{
+    std::stringstream out;
+    basic_xml::gzip_ostream z(out);
+    z << data;
+    z.finish();
+    CATCH_REQUIRE(z);
+    return out.str();
+}
+
+
+std::string decompress(std::string const & data)
+{
+    basic_xml::gzip_istream z(data.data(), data.size());
+    std::stringstream out;
+    out << z.rdbuf();
+    return out.str();
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("gzip", "[gzip][valid]")
+{
+    CATCH_START_SECTION("gzip: compress and decompress")
+    {
+        std::string const doc(generate_document(20'000));
+        std::string const compressed(compress(doc));
+        CATCH_REQUIRE(basic_xml::is_gzip(compressed.data(), compressed.size()));
+        CATCH_REQUIRE_FALSE(basic_xml::is_gzip(doc.data(), doc.size()));
+        CATCH_REQUIRE_FALSE(basic_xml::is_gzip(compressed.data(), 1));
+        CATCH_REQUIRE(compressed.size() < doc.size() / 4);
+        CATCH_REQUIRE(decompress(compressed) == doc);
+
+        // the same from a stream
+        //
+        std::stringstream in(compressed);
+        basic_xml::gzip_istream z(in);
+        std::stringstream out;
+        out << z.rdbuf();
+        CATCH_REQUIRE(out.str() == doc);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("gzip: empty data and concatenated members")
+    {
+        CATCH_REQUIRE(decompress(compress(std::string())).empty());
+        CATCH_REQUIRE(decompress(compress("<a>") + compress("</a>")) == "<a></a>");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("gzip: flush and finish")
+    {
+        std::stringstream out;
+        basic_xml::gzip_ostream z(out, 9);
+        z << "<root>" << std::flush;
+        std::string const partial(out.str());
+        CATCH_REQUIRE(partial.size() > 10);
+        z << "</root>";
+        z.finish();
+        z.finish();
+        CATCH_REQUIRE(decompress(out.str()) == "<root></root>");
+
+        // nothing can be written after finish()
+        //
+        z << "more";
+        z.flush();
+        CATCH_REQUIRE_FALSE(z);
+        CATCH_REQUIRE(decompress(out.str()) == "<root></root>");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("gzip: load a compressed file")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/export.xml.gz");
+        std::string const doc(generate_document(20'000));
+
+        std::stringstream in(doc);
+        basic_xml::xml original("export.xml", in);
+        std::string const expected(SNAP_CATCH2_NAMESPACE::to_string(original.root()));
+
+        // save the tree compressed
+        //
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            basic_xml::gzip_ostream z(f);
+            z << "<?xml version=\"1.0\"?>\n" << *original.root() << "\n";
+        }
+
+        basic_xml::xml x(filename);
+        CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(x.root()) == expected);
+
+        basic_xml::xml y(filename, 4);
+        CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(y.root()) == expected);
+
+        basic_xml::child_reader r(filename);
+        CATCH_REQUIRE(r.root()->tag_name() == "export");
+        std::size_t count(0);
+        for(basic_xml::node::pointer_t row(r.next()); row != nullptr; row = r.next())
+        {
+            CATCH_REQUIRE(row->attribute("id") == std::to_string(count));
+            ++count;
+        }
+        CATCH_REQUIRE(count == 20'000);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("gzip_errors", "[gzip][invalid]")
+{
+    CATCH_START_SECTION("gzip_errors: truncated data")
+    {
+        std::string compressed(compress(generate_document(1'000)));
+        compressed.resize(compressed.size() / 2);
+
+        std::stringstream in(compressed);
+        basic_xml::gzip_istream z(in);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("truncated.xml.gz", z)
+                , basic_xml::compression_error
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: the compressed XML data is truncated."));
+
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/truncated.xml.gz");
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << compressed;
+        }
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml(filename)
+                , basic_xml::compression_error
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: the compressed XML data is truncated."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("gzip_errors: corrupted data")
+    {
+        std::string compressed(compress(generate_document(1'000)));
+        for(std::size_t idx(20); idx < 40; ++idx)
+        {
+            compressed[idx] = static_cast<char>(0xFF);
+        }
+
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/corrupted.xml.gz");
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << compressed;
+        }
+        std::string message;
+        try
+        {
+            basic_xml::xml x(filename);
+        }
+        catch(basic_xml::compression_error const & e)
+        {
+            message = e.what();
+        }
+        CATCH_REQUIRE(message.rfind("xml_error: invalid compressed XML data: ", 0) == 0);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("gzip_errors: parse errors give the same line number")
+    {
+        std::string doc(generate_document(5'000));
+        std::string::size_type const pos(doc.find("<row id=\"4000\">"));
+        CATCH_REQUIRE(pos != std::string::npos);
+        doc.replace(pos, 4, "<=ow");
+        int const line(std::count(doc.begin(), doc.begin() + pos, '\n') + 1);
+
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/invalid.xml.gz");
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << compress(doc);
+        }
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml(filename)
+                , basic_xml::invalid_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":"
+                        + std::to_string(line)
+                        + ":5: character '=' is not valid for a tag name."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
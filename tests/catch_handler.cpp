@@ -0,0 +1,223 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/handler.h>
+
+#include    <basic-xml/exception.h>
+#include    <basic-xml/push_parser.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <fstream>
+#include    <sstream>
+
+
+
+namespace
+{
+
+
+
+class recorder
+    : public basic_xml::handler
+{
+public:
+    virtual void start_tag(std::string_view name) override
+    {
+        f_events += "start:" + std::string(name) + "\n";
+    }
+
+    virtual void attribute(std::string_view name, std::string_view value) override
+    {
+        f_events += "attribute:" + std::string(name) + "=" + std::string(value) + "\n";
+    }
+
+    virtual void text(std::string_view value) override
+    {
+        f_events += "text:" + std::string(value) + "\n";
+    }
+
+    virtual void end_tag(std::string_view name) override
+    {
+        f_events += "end:" + std::string(name) + "\n";
+    }
+
+    virtual void processor(std::string_view value) override
+    {
+        f_events += "processor:" + std::string(value) + "\n";
+    }
+
+    std::string const & events() const
+    {
+        return f_events;
+    }
+
+private:
+    std::string         f_events = std::string();
+};
+
+
+char const g_document[] =
+    "<?xml version=\"1.0\"?>\n"
+    "<!-- comments are not reported -->\n"
+    "<root lang='en' id=\"&lt;1&gt;\">"
+        "Hello &amp; welcome"
+        "<empty flag='yes'/>"
+        "<sub><![CDATA[raw <data>]]></sub>"
+    "</root>\n"
+    "<?done?>\n";
+
+char const g_events[] =
+    "processor:xml version=\"1.0\"\n"
+    "start:root\n"
+    "attribute:lang=en\n"
+    "attribute:id=<1>\n"
+    "text:Hello & welcome\n"
+    "start:empty\n"
+    "attribute:flag=yes\n"
+    "end:empty\n"
+    "start:sub\n"
+    "text:raw <data>\n"
+    "end:sub\n"
+    "end:root\n"
+    "processor:done\n";
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("handler", "[handler][valid]")
+{
+    CATCH_START_SECTION("handler: events from a stream")
+    {
+        std::stringstream ss;
+        ss << g_document;
+
+        recorder r;
+        basic_xml::parse("events.xml", ss, r);
+        CATCH_REQUIRE(r.events() == g_events);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("handler: events from a file")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/events.xml");
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << g_document;
+        }
+
+        recorder r;
+        basic_xml::parse(filename, r);
+        CATCH_REQUIRE(r.events() == g_events);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("handler: events from memory")
+    {
+        recorder r;
+        basic_xml::parse("events.xml", std::string_view(g_document), r);
+        CATCH_REQUIRE(r.events() == g_events);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("handler: events from a push parser")
+    {
+        recorder r;
+        basic_xml::push_parser p("events.xml", r);
+        for(std::size_t idx(0); idx < sizeof(g_document) - 1; ++idx)
+        {
+            p.feed(g_document + idx, 1);
+        }
+        p.finish();
+        CATCH_REQUIRE(r.events() == g_events);
+        CATCH_REQUIRE(p.root() == nullptr);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("handler: default handler ignores all the events")
+    {
+        std::stringstream ss;
+        ss << g_document;
+
+        basic_xml::handler h;
+        basic_xml::parse("ignore.xml", ss, h);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("handler_errors", "[handler][invalid]")
+{
+    CATCH_START_SECTION("handler_errors: events sent before the error are kept")
+    {
+        std::stringstream ss;
+        std::string const filename("mismatch.xml");
+        ss << "<root a='1'><this>text</that></root>";
+
+        recorder r;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::parse(filename, ss, r)
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:30: unexpected token \"that\" in this closing tag; expected \"this\" instead."));
+        CATCH_REQUIRE(r.events() ==
+                  "start:root\n"
+                  "attribute:a=1\n"
+                  "start:this\n"
+                  "text:text\n");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("handler_errors: attribute defined twice, even if empty")
+    {
+        std::stringstream ss;
+        std::string const filename("twice.xml");
+        ss << "<root><sub a='' b='1' a='2'/></root>";
+
+        recorder r;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::parse(filename, ss, r)
+                , basic_xml::invalid_xml
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:28: attribute \"a\" defined twice; we do not allow such."));
+        CATCH_REQUIRE(r.events() == "start:root\n");
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
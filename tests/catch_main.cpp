@@ -34,6 +34,12 @@
 #include    <libexcept/exception.h>
 
 
+// C++
+//
+#include    <fstream>
+#include    <sstream>
+
+
 // last include
 //
 #include    <snapdev/poison.h>
@@ -62,6 +68,24 @@ std::string get_folder_name()
 }
 
 
+std::string to_string(basic_xml::node::pointer_t root)
+{
+    CATCH_REQUIRE(root != nullptr);
+    std::stringstream ss;
+    ss << *root;
+    return ss.str();
+}
+
+
+void write_file(std::string const & filename, std::string const & content)
+{
+    std::ofstream f;
+    f.open(filename);
+    CATCH_REQUIRE(f.is_open());
+    f << content;
+}
+
+
 
 } // namespace 
 
@@ -17,6 +17,11 @@
 // along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
+// basic-xml
+//
+#include    <basic-xml/node.h>
+
+
 // catch2
 //
 #include    <catch2/snapcatch2.hpp>
@@ -47,6 +52,8 @@ namespace SNAP_CATCH2_NAMESPACE
 
 
 extern std::string get_folder_name();
+extern std::string to_string(basic_xml::node::pointer_t root);
+extern void write_file(std::string const & filename, std::string const & content);
 
 
 
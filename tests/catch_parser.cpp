@@ -30,6 +30,8 @@
 
 // C++
 //
+#include    <chrono>
+#include    <iostream>
 #include    <sstream>
 
 
@@ -376,6 +378,97 @@ CATCH_TEST_CASE("parser", "[parser][valid]")
         CATCH_REQUIRE(branch4->text() == "here is an equal = which I think works");
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser: characters spanning input blocks")
+    {
+        std::string const filename("blocks.xml");
+
+        // the parser reads streams in blocks of 64Kb, make sure that
+        // a UTF-8 sequence and a "\r\n" split between two blocks work
+        //
+        std::string const open_tag("<blocks>");
+        std::string text(64 * 1024 - open_tag.length() - 1, 'a');
+        text += "\xC3\xA9";
+        text += std::string(64 * 1024 - 2, 'b');
+        text += "\r\n";
+        text += "end";
+
+        std::stringstream ss;
+        ss << open_tag << text << "</blocks>";
+
+        basic_xml::node::pointer_t root;
+        basic_xml::parser p(filename, ss, root);
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->tag_name() == "blocks");
+        CATCH_REQUIRE(root->text(false) == text.substr(0, text.length() - 5) + "\nend");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser: tokens spanning input blocks")
+    {
+        std::string const filename("tokens.xml");
+
+        // names and values are views of the input buffer, make sure they
+        // survive the buffer being refilled and grown
+        //
+        std::string const name("long-" + std::string(70 * 1024, 'n'));
+        std::string const value(std::string(100 * 1024, 'v') + "\r\nline\rend");
+
+        std::stringstream ss;
+        ss << "<root><" << name << " attr=\"" << value << "\">"
+              "first\r\nsecond"
+              "</" << name << "></root>";
+
+        basic_xml::node::pointer_t root;
+        basic_xml::parser p(filename, ss, root);
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->first_child() != nullptr);
+        CATCH_REQUIRE(root->first_child()->tag_name() == name);
+        CATCH_REQUIRE(root->first_child()->attribute("attr") == std::string(100 * 1024, 'v') + "\nline\nend");
+        CATCH_REQUIRE(root->first_child()->text(false) == "first\nsecond");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser: multibyte characters in sections")
+    {
+        std::string const filename("sections.xml");
+
+        // the comments and CDATA sections are scanned without decoding
+        // the characters, make sure multibyte characters and new lines
+        // are kept intact
+        //
+        std::stringstream ss;
+        ss << "<?xml version='1.0' note='\xC3\xA9t\xC3\xA9'?>"
+              "<!-- caf\xC3\xA9 - \xE2\x80\x94 -- \xF0\x9F\x98\x80\r\n --->"
+              "<r\xC3\xA9sum\xC3\xA9 \xC3\xA9t\xC3\xA9='\xE2\x82\xAC 5'>"
+                "\xC3\xA9l\xC3\xA8ve<![CDATA[ \xE2\x80\x94]\r\n\xF0\x9F\x98\x80]] ]]]>"
+              "</r\xC3\xA9sum\xC3\xA9>";
+
+        basic_xml::node::pointer_t root;
+        basic_xml::parser p(filename, ss, root);
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->tag_name() == "r\xC3\xA9sum\xC3\xA9");
+        CATCH_REQUIRE(root->attribute("\xC3\xA9t\xC3\xA9") == "\xE2\x82\xAC 5");
+        CATCH_REQUIRE(root->text(false) == "\xC3\xA9l\xC3\xA8ve \xE2\x80\x94]\n\xF0\x9F\x98\x80]] ]");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser: back to back entities")
+    {
+        std::string const filename("entities.xml");
+
+        std::stringstream ss;
+        ss << "<dense a='&amp;&lt;&gt;&quot;&apos;&#65;&#x42;'>"
+              "&lt;p&gt;Caf&#xE9; &#x2014; &#8364;&#x1F600;&#X10FFFF;&#00065;&lt;/p&gt; & kept"
+              "</dense>";
+
+        basic_xml::node::pointer_t root;
+        basic_xml::parser p(filename, ss, root);
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->attribute("a") == "&<>\"'AB");
+        CATCH_REQUIRE(root->text(false) == "<p>Caf\xC3\xA9 \xE2\x80\x94 \xE2\x82\xAC\xF0\x9F\x98\x80\xF4\x8F\xBF\xBF" "A</p> & kept");
+    }
+    CATCH_END_SECTION()
 }
 
 
@@ -393,7 +486,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
+                        + ":1:1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
     }
     CATCH_END_SECTION()
 
@@ -410,7 +503,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
+                        + ":2:1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
     }
     CATCH_END_SECTION()
 
@@ -427,7 +520,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
+                        + ":2:1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
     }
     CATCH_END_SECTION()
 
@@ -446,7 +539,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":4: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
+                        + ":4:1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
     }
     CATCH_END_SECTION()
 
@@ -465,7 +558,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":4: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
+                        + ":4:3: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
     }
     CATCH_END_SECTION()
 
@@ -483,7 +576,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: root tag cannot be an empty tag.", true));
+                        + ":2:8: root tag cannot be an empty tag.", true));
     }
     CATCH_END_SECTION()
 
@@ -501,7 +594,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: unexpected token \"that\" in this closing tag; expected \"this\" instead."));
+                        + ":2:29: unexpected token \"that\" in this closing tag; expected \"this\" instead."));
     }
     CATCH_END_SECTION()
 
@@ -519,7 +612,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":3: cannot include text data before or after the root tag."));
+                        + ":3:1: cannot include text data before or after the root tag."));
     }
     CATCH_END_SECTION()
 
@@ -537,7 +630,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: we reached the end of the XML file, but still"
+                        + ":2:51: we reached the end of the XML file, but still"
                           " found a token of type 6 after the closing root tag"
                           " instead of the end of the file."));
     }
@@ -557,7 +650,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":3: reached the end of the file without first"
+                        + ":3:1: reached the end of the file without first"
                           " closing the root tag."));
     }
     CATCH_END_SECTION()
@@ -575,7 +668,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: expected the end of the tag (>) or an attribute name."));
+                        + ":1:29: expected the end of the tag (>) or an attribute name."));
     }
     CATCH_END_SECTION()
 
@@ -592,7 +685,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: expected the '=' character between the attribute name and value."));
+                        + ":1:26: expected the '=' character between the attribute name and value."));
     }
     CATCH_END_SECTION()
 
@@ -609,7 +702,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: expected a quoted value after the '=' sign."));
+                        + ":1:24: expected a quoted value after the '=' sign."));
     }
     CATCH_END_SECTION()
 
@@ -626,7 +719,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: attribute \"attr\" defined twice; we do not allow such."));
+                        + ":1:37: attribute \"attr\" defined twice; we do not allow such."));
     }
     CATCH_END_SECTION()
 
@@ -643,7 +736,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: reached the end of the file while reading a processor (\"<?...?>\") tag."));
+                        + ":2:1: reached the end of the file while reading a processor (\"<?...?>\") tag."));
     }
     CATCH_END_SECTION()
 
@@ -660,7 +753,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: found an element definition (such as an \"<!ELEMENT...>\" sequence), which is not supported."));
+                        + ":1:19: found an element definition (such as an \"<!ELEMENT...>\" sequence), which is not supported."));
     }
     CATCH_END_SECTION()
 
@@ -677,7 +770,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: found an unexpected sequence of character in a \"<![CDATA[...\" sequence."));
+                        + ":1:20: found an unexpected sequence of character in a \"<![CDATA[...\" sequence."));
     }
     CATCH_END_SECTION()
 
@@ -694,7 +787,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: found EOF while parsing a \"<![CDATA[...]]>\" sequence."));
+                        + ":2:1: found EOF while parsing a \"<![CDATA[...]]>\" sequence."));
     }
     CATCH_END_SECTION()
 
@@ -711,7 +804,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":7: found EOF while parsing a comment (\"<!--...-->\") sequence."));
+                        + ":7:1: found EOF while parsing a comment (\"<!--...-->\") sequence."));
     }
     CATCH_END_SECTION()
 
@@ -728,7 +821,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: character '+' was not expected after a \"<!\" sequence."));
+                        + ":1:19: character '+' was not expected after a \"<!\" sequence."));
     }
     CATCH_END_SECTION()
 
@@ -745,7 +838,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: expected a tag name after \"</\", not EOF."));
+                        + ":2:1: expected a tag name after \"</\", not EOF."));
     }
     CATCH_END_SECTION()
 
@@ -762,7 +855,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: character '-' is not valid for a tag name."));
+                        + ":1:34: character '-' is not valid for a tag name."));
     }
     CATCH_END_SECTION()
 
@@ -779,7 +872,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: expected '>', not EOF."));
+                        + ":2:1: expected '>', not EOF."));
     }
     CATCH_END_SECTION()
 
@@ -796,7 +889,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: found an unexpected ';' in a closing tag, expected '>' instead."));
+                        + ":1:43: found an unexpected ';' in a closing tag, expected '>' instead."));
     }
     CATCH_END_SECTION()
 
@@ -813,7 +906,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":2: expected a tag name after '<', not EOF."));
+                        + ":2:1: expected a tag name after '<', not EOF."));
     }
     CATCH_END_SECTION()
 
@@ -830,7 +923,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: character '{' is not valid for a tag name."));
+                        + ":1:9: character '{' is not valid for a tag name."));
     }
     CATCH_END_SECTION()
 
@@ -847,7 +940,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: character '}' is not valid right after a tag name."));
+                        + ":1:16: character '}' is not valid right after a tag name."));
     }
     CATCH_END_SECTION()
 
@@ -864,7 +957,32 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: character '>' not expected inside a tag value; please use \"&gt;\" instead."));
+                        + ":1:35: character '>' not expected inside a tag value; please use \"&gt;\" instead."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser_errors: end of file inside an attribute value")
+    {
+        std::string const filename("truncated.xml");
+        std::string const xml("<a b=\"xyz");
+
+        basic_xml::node::pointer_t root;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::parser(filename, xml.data(), xml.length(), root)
+                , basic_xml::unexpected_eof
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:10: reached the end of the file while reading an attribute value."));
+
+        std::stringstream ss(xml);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::parser(filename, ss, root)
+                , basic_xml::unexpected_eof
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:10: reached the end of the file while reading an attribute value."));
     }
     CATCH_END_SECTION()
 
@@ -881,7 +999,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: the name of an entity cannot be empty (\"&;\" is not valid XML)."));
+                        + ":1:39: the name of an entity cannot be empty (\"&;\" is not valid XML)."));
     }
     CATCH_END_SECTION()
 
@@ -898,7 +1016,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: a numeric entity must have a number (\"&#;\" is not valid XML)."));
+                        + ":1:48: a numeric entity must have a number (\"&#;\" is not valid XML)."));
     }
     CATCH_END_SECTION()
 
@@ -915,7 +1033,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: the number found in numeric entity, \" 12ab34\", is not considered valid."));
+                        + ":1:54: the number found in numeric entity, \" 12ab34\", is not considered valid."));
     }
     CATCH_END_SECTION()
 
@@ -932,7 +1050,46 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: the number found in numeric entity, \"0x10abz4\", is not considered valid."));
+                        + ":1:55: the number found in numeric entity, \"0x10abz4\", is not considered valid."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser_errors: numeric entities which are not valid characters")
+    {
+        char const * const invalid_numbers[] =
+        {
+            "0",
+            "x0",
+            "x",
+            "-65",
+            "x110000",
+            "1114112",
+            "xD800",
+            "57343",
+            "99999999999999999999",
+        };
+        for(auto const & n : invalid_numbers)
+        {
+            std::stringstream ss;
+            std::string const filename("element.xml");
+            ss << "<root><sub-tag name='numeric entity: &#" << n << ";'>bad number</sub-tag></root>\n";
+
+            std::string name(n);
+            name.insert(0, 1, n[0] == 'x' ? '0' : ' ');
+
+            basic_xml::node::pointer_t root;
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::parser(filename, ss, root)
+                    , basic_xml::invalid_number
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: "
+                            + filename
+                            + ":1:"
+                            + std::to_string(41 + name.length())
+                            + ": the number found in numeric entity, \""
+                            + name
+                            + "\", is not considered valid."));
+        }
     }
     CATCH_END_SECTION()
 
@@ -949,7 +1106,7 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: unsupported entity (\"&unknown;\")."));
+                        + ":1:54: unsupported entity (\"&unknown;\")."));
     }
     CATCH_END_SECTION()
 
@@ -966,7 +1123,128 @@ CATCH_TEST_CASE("parser_errors", "[parser][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: expected the end of the tag (>) or an attribute name."));
+                        + ":1:28: expected the end of the tag (>) or an attribute name."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser_errors: invalid UTF-8 in a stream")
+    {
+        std::stringstream ss;
+        std::string const filename("utf8.xml");
+        ss << "<root><sub-tag name='caf\xC3\xA9'>bad \xC3\x28 sequence</sub-tag></root>\n";
+
+        basic_xml::node::pointer_t root;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::parser(filename, ss, root)
+                , basic_xml::invalid_utf8
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ": invalid UTF-8 sequence found at byte offset 32."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser_errors: invalid UTF-8 in a buffer")
+    {
+        std::string const filename("utf8.xml");
+        std::string const xml("<root><sub-tag name='\xED\xA0\x80'>surrogates are not valid</sub-tag></root>\n");
+
+        basic_xml::node::pointer_t root;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::parser(filename, xml.data(), xml.length(), root)
+                , basic_xml::invalid_utf8
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ": invalid UTF-8 sequence found at byte offset 21."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser_errors: truncated UTF-8 at the end of the input")
+    {
+        std::stringstream ss;
+        std::string const filename("utf8.xml");
+        ss << "<root>text</root>\xE2\x82";
+
+        basic_xml::node::pointer_t root;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::parser(filename, ss, root)
+                , basic_xml::invalid_utf8
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ": invalid UTF-8 sequence found at byte offset 17."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("parser_errors: line and column after many input blocks")
+    {
+        // the lines are counted from the position of the error, make sure
+        // the count survives the buffer being refilled, including a "\r\n"
+        // split between two blocks and a long line spanning blocks
+        //
+        std::string const filename("location.xml");
+        std::string doc("<root>\n");
+        for(int i(0); i < 20000; ++i)
+        {
+            doc += "<line>text</line>\r\n";
+        }
+        doc += "<long>" + std::string(100 * 1024, 'x') + "</long>\r";
+        doc += "\xC3\xA9t\xC3\xA9 <=bad/></root>";
+
+        for(int mode(0); mode < 2; ++mode)
+        {
+            basic_xml::node::pointer_t root;
+            std::stringstream ss;
+            ss << doc;
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      mode == 0
+                        ? basic_xml::parser(filename, ss, root)
+                        : basic_xml::parser(filename, doc.data(), doc.length(), root)
+                    , basic_xml::invalid_token
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: "
+                            + filename
+                            + ":20003:7: character '=' is not valid for a tag name."));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+CATCH_TEST_CASE("parser_benchmark", "[parser][benchmark][.]")
+{
+    CATCH_START_SECTION("parser_benchmark: entity heavy text")
+    {
+        // this test is hidden; run it with: unittest "[benchmark]"
+        //
+        std::string const filename("entities.xml");
+        std::string const line("&lt;p class=&quot;note&quot;&gt;Caf&#xE9; &amp; cr&#232;me &#x2014; &apos;quoted&apos; &lt;b&gt;bold&lt;/b&gt;&lt;/p&gt;\n");
+        std::string const expected_line("<p class=\"note\">Caf\xC3\xA9 & cr\xC3\xA8me \xE2\x80\x94 'quoted' <b>bold</b></p>\n");
+        std::size_t const count(8 * 1024 * 1024 / line.length());
+        std::string doc("<dump>");
+        std::string expected;
+        for(std::size_t idx(0); idx < count; ++idx)
+        {
+            doc += line;
+            expected += expected_line;
+        }
+        doc += "</dump>";
+
+        auto const start(std::chrono::steady_clock::now());
+        basic_xml::node::pointer_t root;
+        basic_xml::parser p(filename, doc.data(), doc.length(), root);
+        std::chrono::duration<double> const duration(std::chrono::steady_clock::now() - start);
+
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->text(false) == expected);
+
+        std::cout << "--- parsed " << doc.length() / 1024
+                  << " KiB of entity heavy text in " << duration.count()
+                  << "s ("
+                  << static_cast<double>(doc.length()) / 1048576.0 / duration.count()
+                  << " MiB/s).\n";
     }
     CATCH_END_SECTION()
 }
@@ -0,0 +1,311 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/push_parser.h>
+
+#include    <basic-xml/exception.h>
+#include    <basic-xml/parser.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <algorithm>
+
+
+
+namespace
+{
+
+
+
+char const g_document[] =
+    "<?xml version=\"1.0\"?>\r\n"
+    "<!-- a comment with <tags> & such -->\n"
+    "<root lang='fr' title=\"&lt;caf&#xE9;&gt;\">\r\n"
+    "  <item id=\"1\">Caf\xC3\xA9 cr\xC3\xA8me &amp; \xF0\x9F\x98\x80</item>\n"
+    "  <item id=\"2\"><![CDATA[<raw> ]] & ]]]></item>\n"
+    "  <empty flag='yes'/>\n"
+    "  <!-- another comment -->\n"
+    "  <deep><deeper>&#8364;&#x1F600;&apos;</deeper></deep>\n"
+    "</root>\n"
+    "<?end of document?>\n";
+
+
+std::string expected_tree()
+{
+    basic_xml::node::pointer_t root;
+    basic_xml::parser p("expected.xml", g_document, sizeof(g_document) - 1, root);
+    return SNAP_CATCH2_NAMESPACE::to_string(root);
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("push_parser", "[push_parser][valid]")
+{
+    CATCH_START_SECTION("push_parser: whole document in one chunk")
+    {
+        basic_xml::push_parser p("one-chunk.xml");
+        p.feed(g_document, sizeof(g_document) - 1);
+        p.finish();
+        CATCH_REQUIRE(p.root()->tag_name() == "root");
+        CATCH_REQUIRE(p.root()->attribute("title") == "<caf\xC3\xA9>");
+        CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(p.root()) == expected_tree());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser: one byte at a time")
+    {
+        basic_xml::push_parser p("bytes.xml");
+        for(std::size_t idx(0); idx < sizeof(g_document) - 1; ++idx)
+        {
+            p.feed(g_document + idx, 1);
+        }
+        p.finish();
+        CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(p.root()) == expected_tree());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser: split at every position")
+    {
+        std::string const expected(expected_tree());
+        for(std::size_t split(0); split <= sizeof(g_document) - 1; ++split)
+        {
+            basic_xml::push_parser p("split.xml");
+            p.feed(g_document, split);
+            p.feed(g_document + split, sizeof(g_document) - 1 - split);
+            p.finish();
+            CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(p.root()) == expected);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser: scatter-gather chain")
+    {
+        std::size_t const size(sizeof(g_document) - 1);
+        iovec chain[4];
+        chain[0].iov_base = const_cast<char *>(g_document);
+        chain[0].iov_len = 7;
+        chain[1].iov_base = const_cast<char *>(g_document + 7);
+        chain[1].iov_len = 0;
+        chain[2].iov_base = const_cast<char *>(g_document + 7);
+        chain[2].iov_len = 100;
+        chain[3].iov_base = const_cast<char *>(g_document + 107);
+        chain[3].iov_len = size - 107;
+
+        basic_xml::push_parser p("chain.xml");
+        p.feed(chain, 2);
+        CATCH_REQUIRE(p.root() == nullptr);
+        p.feed(chain + 2, 2);
+        p.finish();
+        CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(p.root()) == expected_tree());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser: large text in small chunks")
+    {
+        std::string doc("<large>");
+        std::string text;
+        for(int idx(0); idx < 10000; ++idx)
+        {
+            text += "line " + std::to_string(idx) + " &amp; more\n";
+        }
+        doc += text;
+        doc += "</large>";
+
+        basic_xml::push_parser p("large.xml");
+        for(std::size_t pos(0); pos < doc.length(); pos += 100)
+        {
+            p.feed(doc.data() + pos, std::min(static_cast<std::size_t>(100), doc.length() - pos));
+        }
+        p.finish();
+        CATCH_REQUIRE(p.root()->tag_name() == "large");
+        std::string::size_type amp(0);
+        while((amp = text.find("&amp;", amp)) != std::string::npos)
+        {
+            text.replace(amp, 5, "&");
+            ++amp;
+        }
+        CATCH_REQUIRE(p.root()->text(false) == text);
+    }
+    CATCH_END_SECTION()
+    CATCH_START_SECTION("push_parser: limits do not depend on the chunk size")
+    {
+        // a tag cut by the end of a chunk gets parsed again, it must
+        // not be counted twice
+        //
+        char const doc[] = "<root><item name='a' value='b'/><item name='c' value='d'/></root>";
+        for(std::size_t const chunk : { 1, 2, 3, 7, 1000 })
+        {
+            basic_xml::parse_options options;
+            options.f_max_nodes = 3;
+            options.f_max_attributes = 2;
+            options.f_max_memory = 2048;
+            basic_xml::push_parser p("push", options);
+            for(std::size_t idx(0); idx < sizeof(doc) - 1; idx += chunk)
+            {
+                p.feed(doc + idx, std::min(chunk, sizeof(doc) - 1 - idx));
+            }
+            p.finish();
+            CATCH_REQUIRE(p.root()->last_child()->attribute("value") == "d");
+
+            options.f_max_nodes = 2;
+            basic_xml::push_parser q("push", options);
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      [&]()
+                      {
+                          for(std::size_t idx(0); idx < sizeof(doc) - 1; idx += chunk)
+                          {
+                              q.feed(doc + idx, std::min(chunk, sizeof(doc) - 1 - idx));
+                          }
+                          q.finish();
+                      }()
+                    , basic_xml::limit_exceeded
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: push:1:39: number of nodes (3) is over the limit of 2."));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("push_parser_errors", "[push_parser][invalid]")
+{
+    CATCH_START_SECTION("push_parser_errors: nothing fed")
+    {
+        std::string const filename("empty.xml");
+        basic_xml::push_parser p(filename);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.finish()
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:1: cannot be empty or include anything other than a processor tag and comments before the root tag."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser_errors: root tag not closed")
+    {
+        std::string const filename("open.xml");
+        basic_xml::push_parser p(filename);
+        p.feed("<root>\n<sub>text</sub>\n", 23);
+        CATCH_REQUIRE(p.root() != nullptr);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.finish()
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":3:1: reached the end of the file without first closing the root tag."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser_errors: end of data inside a comment")
+    {
+        std::string const filename("comment.xml");
+        basic_xml::push_parser p(filename);
+        p.feed("<root><!-- not closed", 21);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.finish()
+                , basic_xml::unexpected_eof
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:22: found EOF while parsing a comment (\"<!--...-->\") sequence."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser_errors: end of data inside a UTF-8 character")
+    {
+        std::string const filename("utf8.xml");
+        basic_xml::push_parser p(filename);
+        p.feed("<root>caf\xC3", 10);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.finish()
+                , basic_xml::invalid_utf8
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ": invalid UTF-8 sequence found at byte offset 9."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser_errors: invalid UTF-8 in a later chunk")
+    {
+        std::string const filename("utf8.xml");
+        basic_xml::push_parser p(filename);
+        p.feed("<root>text</root>", 6);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.feed("ok \xFF", 4)
+                , basic_xml::invalid_utf8
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ": invalid UTF-8 sequence found at byte offset 9."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser_errors: error found while feeding")
+    {
+        std::string const filename("mismatch.xml");
+        basic_xml::push_parser p(filename);
+        p.feed("<root><this>", 12);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.feed("incorrect</that>", 16)
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:29: unexpected token \"that\" in this closing tag; expected \"this\" instead."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("push_parser_errors: feed after finish")
+    {
+        basic_xml::push_parser p("finished.xml");
+        p.feed("<root/>", 0);
+        p.feed("<root></root>", 13);
+        p.finish();
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.feed("<more/>", 7)
+                , basic_xml::logic_error
+                , Catch::Matchers::ExceptionMessage(
+                          "logic_error: feed() called after finish()."));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.finish()
+                , basic_xml::logic_error
+                , Catch::Matchers::ExceptionMessage(
+                          "logic_error: finish() called twice on the same parser."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
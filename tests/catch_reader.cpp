@@ -0,0 +1,251 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/prinbee
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/reader.h>
+
+#include    <basic-xml/exception.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <fstream>
+#include    <sstream>
+
+
+
+namespace
+{
+
+
+
+char const g_document[] =
+    "<?xml version=\"1.0\"?>\n"
+    "<!-- comments are skipped -->\n"
+    "<catalog version='3'>"
+        "<book id=\"b1\" lang='en'>"
+            "<title>First &amp; Last</title>"
+            "<chapters><chapter n='1'>One</chapter><chapter n='2'/></chapters>"
+        "</book>"
+        "<book id=\"b2\">"
+            "<title>Second</title>"
+        "</book>"
+    "</catalog>\n";
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("reader", "[reader][valid]")
+{
+    CATCH_START_SECTION("reader: walk all the elements")
+    {
+        basic_xml::reader r("catalog.xml", g_document, sizeof(g_document) - 1);
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_NONE);
+
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_PROCESSOR);
+        CATCH_REQUIRE(r.value() == "xml version=\"1.0\"");
+
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_START_TAG);
+        CATCH_REQUIRE(r.name() == "catalog");
+        CATCH_REQUIRE(r.depth() == 0);
+        CATCH_REQUIRE(r.attribute_count() == 1);
+        CATCH_REQUIRE(r.attribute("version") == "3");
+
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_START_TAG);
+        CATCH_REQUIRE(r.name() == "book");
+        CATCH_REQUIRE(r.depth() == 1);
+        CATCH_REQUIRE(r.attribute_count() == 2);
+        CATCH_REQUIRE(r.has_attribute("id"));
+        CATCH_REQUIRE(r.attribute("id") == "b1");
+        CATCH_REQUIRE(r.attribute("lang") == "en");
+        CATCH_REQUIRE_FALSE(r.has_attribute("missing"));
+        CATCH_REQUIRE(r.attribute("missing").empty());
+
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_START_TAG);
+        CATCH_REQUIRE(r.name() == "title");
+        CATCH_REQUIRE(r.depth() == 2);
+
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_TEXT);
+        CATCH_REQUIRE(r.value() == "First & Last");
+        CATCH_REQUIRE(r.depth() == 3);
+
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_TAG);
+        CATCH_REQUIRE(r.name() == "title");
+        CATCH_REQUIRE(r.depth() == 2);
+
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.name() == "chapters");
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.name() == "chapter");
+        CATCH_REQUIRE(r.attribute("n") == "1");
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.value() == "One");
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_TAG);
+
+        // empty tag generates a start and an end
+        //
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_START_TAG);
+        CATCH_REQUIRE(r.name() == "chapter");
+        CATCH_REQUIRE(r.attribute("n") == "2");
+        CATCH_REQUIRE(r.depth() == 3);
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_TAG);
+        CATCH_REQUIRE(r.name() == "chapter");
+        CATCH_REQUIRE(r.attribute_count() == 0);
+        CATCH_REQUIRE(r.depth() == 3);
+
+        std::string names;
+        while(r.next())
+        {
+            names += r.name() + ',';
+        }
+        CATCH_REQUIRE(names == "chapters,book,book,title,,title,book,catalog,");
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_OF_FILE);
+        CATCH_REQUIRE_FALSE(r.next());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("reader: skip sub-trees")
+    {
+        std::stringstream ss;
+        ss << g_document;
+
+        basic_xml::reader r("catalog.xml", ss);
+        std::string titles;
+        while(r.next())
+        {
+            if(r.kind() != basic_xml::reader::kind_t::KIND_START_TAG)
+            {
+                continue;
+            }
+            if(r.name() == "chapters")
+            {
+                r.skip_subtree();
+                CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_TAG);
+                CATCH_REQUIRE(r.name() == "chapters");
+                CATCH_REQUIRE(r.depth() == 2);
+            }
+            else if(r.name() == "title")
+            {
+                CATCH_REQUIRE(r.next());
+                titles += r.value() + ';';
+            }
+        }
+        CATCH_REQUIRE(titles == "First & Last;Second;");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("reader: skip empty tag and other elements")
+    {
+        basic_xml::reader r("catalog.xml", g_document, sizeof(g_document) - 1);
+        CATCH_REQUIRE(r.next());
+        r.skip_subtree(); // on a processor, does nothing
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_PROCESSOR);
+
+        while(r.next()
+           && !(r.name() == "chapter" && r.attribute("n") == "2"))
+        {
+        }
+        r.skip_subtree();
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_TAG);
+        CATCH_REQUIRE(r.name() == "chapter");
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_TAG);
+        CATCH_REQUIRE(r.name() == "chapters");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("reader: skip the root and stop early")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/catalog.xml");
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << g_document;
+        }
+
+        basic_xml::reader r(filename);
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.name() == "catalog");
+        r.skip_subtree();
+        CATCH_REQUIRE(r.kind() == basic_xml::reader::kind_t::KIND_END_TAG);
+        CATCH_REQUIRE(r.name() == "catalog");
+        CATCH_REQUIRE(r.depth() == 0);
+        CATCH_REQUIRE_FALSE(r.next());
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("reader_errors", "[reader][invalid]")
+{
+    CATCH_START_SECTION("reader_errors: error reported when reached")
+    {
+        std::string const filename("mismatch.xml");
+        char const doc[] = "<root><this>text</that></root>";
+
+        basic_xml::reader r(filename, doc, sizeof(doc) - 1);
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.next());
+        CATCH_REQUIRE(r.value() == "text");
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  r.next()
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:24: unexpected token \"that\" in this closing tag; expected \"this\" instead."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("reader_errors: file missing")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/reader-does-not-exist.xml");
+
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::reader(filename)
+                , basic_xml::file_not_found);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,383 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/scan.h>
+
+
+// C++
+//
+#include    <utility>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+
+CATCH_TEST_CASE("scan", "[scan][valid]")
+{
+    CATCH_START_SECTION("scan: no special characters")
+    {
+        // try all sizes so we test the AVX2, SSE2, and byte by byte loops
+        //
+        for(std::size_t size(0); size < 100; ++size)
+        {
+            std::string const plain(size, 'a');
+            char const * s(plain.data());
+            char const * e(s + plain.length());
+            CATCH_REQUIRE(basic_xml::find_text_special(s, e) == e);
+            CATCH_REQUIRE(basic_xml::find_value_special(s, e, '"') == e);
+            CATCH_REQUIRE(basic_xml::find_value_special(s, e, '\'') == e);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: special characters in text")
+    {
+        for(char const special : std::string("<&\r\n"))
+        {
+            for(std::size_t pos(0); pos < 100; ++pos)
+            {
+                std::string text(100, 'b');
+                text[pos] = special;
+                char const * s(text.data());
+                char const * e(s + text.length());
+                CATCH_REQUIRE(basic_xml::find_text_special(s, e) == s + pos);
+            }
+        }
+
+        // the quotes, '>', and UTF-8 are not special in text
+        //
+        std::string const text(std::string(50, 'c') + "\"'>\xC3\xA9" + std::string(50, 'c'));
+        char const * s(text.data());
+        char const * e(s + text.length());
+        CATCH_REQUIRE(basic_xml::find_text_special(s, e) == e);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: special characters in attribute values")
+    {
+        for(char const quote : std::string("\"'"))
+        {
+            for(char const special : std::string(1, quote) + ">&\r\n")
+            {
+                for(std::size_t pos(0); pos < 100; ++pos)
+                {
+                    std::string value(100, 'd');
+                    value[pos] = special;
+                    char const * s(value.data());
+                    char const * e(s + value.length());
+                    CATCH_REQUIRE(basic_xml::find_value_special(s, e, quote) == s + pos);
+                }
+            }
+
+            // the other quote, '<', and UTF-8 are not special
+            //
+            std::string const value(std::string(50, 'e') + (quote == '"' ? "'" : "\"") + "<\xE2\x82\xAC" + std::string(50, 'e'));
+            char const * s(value.data());
+            char const * e(s + value.length());
+            CATCH_REQUIRE(basic_xml::find_value_special(s, e, quote) == e);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: count lines")
+    {
+        // "\r\n", "\r", and "\n" count as one line each, try all the
+        // positions so the sequences cross the vector boundaries
+        //
+        for(std::size_t pos(0); pos < 100; ++pos)
+        {
+            std::string text(100, 'l');
+            text.insert(pos, "\r\n\n\r\r\n\r");
+            char const * s(text.data());
+            char const * e(s + text.length());
+            bool cr(false);
+            CATCH_REQUIRE(basic_xml::count_lines(s, e, cr) == 5);
+            CATCH_REQUIRE(cr == (pos == 100));
+
+            // split the buffer anywhere, a "\r\n" across the split still
+            // counts as one line
+            //
+            for(std::size_t split(0); split <= text.length(); split += 7)
+            {
+                cr = false;
+                std::size_t count(basic_xml::count_lines(s, s + split, cr));
+                count += basic_xml::count_lines(s + split, e, cr);
+                CATCH_REQUIRE(count == 5);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: valid UTF-8")
+    {
+        // one sequence of each length and the limits of each range
+        //
+        std::string const sequences[] =
+        {
+            "A",
+            "\x7F",
+            "\xC2\x80",
+            "\xDF\xBF",
+            "\xE0\xA0\x80",
+            "\xED\x9F\xBF",
+            "\xEE\x80\x80",
+            "\xEF\xBF\xBF",
+            "\xF0\x90\x80\x80",
+            "\xF4\x8F\xBF\xBF",
+        };
+        for(auto const & seq : sequences)
+        {
+            // place the sequence at all the positions of a block so we
+            // test the vectorized code and the byte by byte loop
+            //
+            for(std::size_t pos(0); pos < 70; ++pos)
+            {
+                std::string const text(std::string(pos, 'f') + seq + std::string(70 - pos, 'g'));
+                char const * s(text.data());
+                char const * e(s + text.length());
+                bool truncated(true);
+                CATCH_REQUIRE(basic_xml::find_invalid_utf8(s, e, truncated) == e);
+                CATCH_REQUIRE_FALSE(truncated);
+
+                // the same sequence repeated many times
+                //
+                std::string repeated(pos, 'h');
+                for(int count(0); count < 40; ++count)
+                {
+                    repeated += seq;
+                }
+                s = repeated.data();
+                e = s + repeated.length();
+                CATCH_REQUIRE(basic_xml::find_invalid_utf8(s, e, truncated) == e);
+                CATCH_REQUIRE_FALSE(truncated);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: invalid UTF-8")
+    {
+        std::string const sequences[] =
+        {
+            "\x80",                    // continuation without lead
+            "\xBF",
+            "\xC0\x80",                // overlong
+            "\xC1\xBF",
+            "\xC2",                    // too short
+            "\xC2\xC2\x80",
+            "\xE0\x80\x80",            // overlong
+            "\xE0\x9F\xBF",
+            "\xED\xA0\x80",            // surrogate
+            "\xED\xBF\xBF",
+            "\xE1\x80",                // too short
+            "\xF0\x80\x80\x80",        // overlong
+            "\xF0\x8F\xBF\xBF",
+            "\xF4\x90\x80\x80",        // over U+10FFFF
+            "\xF5\x80\x80\x80",
+            "\xF1\x80\x80",            // too short
+            "\xF8\x88\x80\x80\x80",    // not UTF-8 anymore
+            "\xFF",
+        };
+        for(auto const & seq : sequences)
+        {
+            for(std::size_t pos(0); pos < 70; ++pos)
+            {
+                std::string const text(std::string(pos, 'i') + "\xC3\xA9" + seq + std::string(70 - pos, 'j'));
+                char const * s(text.data());
+                char const * e(s + text.length());
+                bool truncated(true);
+                CATCH_REQUIRE(basic_xml::find_invalid_utf8(s, e, truncated) == s + pos + 2);
+                CATCH_REQUIRE_FALSE(truncated);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: truncated UTF-8")
+    {
+        std::string const sequences[] =
+        {
+            "\xC3",
+            "\xE2",
+            "\xE2\x82",
+            "\xF0",
+            "\xF0\x9F",
+            "\xF0\x9F\x98",
+        };
+        for(auto const & seq : sequences)
+        {
+            for(std::size_t pos(0); pos < 70; ++pos)
+            {
+                std::string const text(std::string(pos, 'k') + seq);
+                char const * s(text.data());
+                char const * e(s + text.length());
+                bool truncated(false);
+                CATCH_REQUIRE(basic_xml::find_invalid_utf8(s, e, truncated) == s + pos);
+                CATCH_REQUIRE(truncated);
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: empty UTF-8 buffers")
+    {
+        bool truncated(true);
+        CATCH_REQUIRE(basic_xml::find_invalid_utf8(nullptr, nullptr, truncated) == nullptr);
+        CATCH_REQUIRE_FALSE(truncated);
+
+        std::string const empty;
+        char const * s(empty.data());
+        truncated = true;
+        CATCH_REQUIRE(basic_xml::find_invalid_utf8(s, s, truncated) == s);
+        CATCH_REQUIRE_FALSE(truncated);
+
+        // an error at the very start of the buffer, there is nothing
+        // before it to look at
+        //
+        std::string const text(std::string("\x80") + std::string(40, 'l'));
+        s = text.data();
+        CATCH_REQUIRE(basic_xml::find_invalid_utf8(s, s + text.length(), truncated) == s);
+        CATCH_REQUIRE_FALSE(truncated);
+    }
+    CATCH_END_SECTION()
+    CATCH_START_SECTION("scan: convert UTF-16")
+    {
+        // one character of each UTF-8 length, including a surrogate pair,
+        // placed at all the positions of a block
+        //
+        struct utf16_character
+        {
+            std::string     f_le = std::string();
+            std::string     f_utf8 = std::string();
+        };
+        utf16_character const characters[] =
+        {
+            { std::string("A\0", 2),                 "A" },
+            { std::string("\xE9\0", 2),              "\xC3\xA9" },
+            { "\xAC\x20",                            "\xE2\x82\xAC" },
+            { "\xFF\xFF",                            "\xEF\xBF\xBF" },
+            { std::string("\x3D\xD8\x00\xDE", 4),    "\xF0\x9F\x98\x80" },
+        };
+        for(auto const & c : characters)
+        {
+            for(bool const big_endian : { false, true })
+            {
+                std::string unit(c.f_le);
+                if(big_endian)
+                {
+                    for(std::size_t idx(0); idx < unit.length(); idx += 2)
+                    {
+                        std::swap(unit[idx], unit[idx + 1]);
+                    }
+                }
+                std::string const a(big_endian ? std::string("\0a", 2) : std::string("a\0", 2));
+                for(std::size_t pos(0); pos < 40; ++pos)
+                {
+                    std::string text;
+                    for(std::size_t idx(0); idx < pos; ++idx)
+                    {
+                        text += a;
+                    }
+                    text += unit;
+                    for(std::size_t idx(0); idx < 40; ++idx)
+                    {
+                        text += a;
+                    }
+                    std::string const expected(std::string(pos, 'a') + c.f_utf8 + std::string(40, 'a'));
+
+                    std::string buffer(text.length() / 2 * 3, '\0');
+                    char * out(buffer.data());
+                    bool truncated(true);
+                    CATCH_REQUIRE(basic_xml::convert_utf16(text.data(), text.data() + text.length(), big_endian, out, truncated) == text.data() + text.length());
+                    CATCH_REQUIRE_FALSE(truncated);
+                    CATCH_REQUIRE(std::string(buffer.data(), out) == expected);
+
+                    // cut the input at the character, a split surrogate
+                    // pair is reported as truncated
+                    //
+                    out = buffer.data();
+                    std::size_t const cut(pos * 2 + 2);
+                    char const * const p(basic_xml::convert_utf16(text.data(), text.data() + cut, big_endian, out, truncated));
+                    if(unit.length() == 4)
+                    {
+                        CATCH_REQUIRE(p == text.data() + pos * 2);
+                        CATCH_REQUIRE(truncated);
+                    }
+                    else
+                    {
+                        CATCH_REQUIRE(p == text.data() + cut);
+                        CATCH_REQUIRE_FALSE(truncated);
+                    }
+                    CATCH_REQUIRE(std::string(buffer.data(), out) == std::string(pos, 'a') + (unit.length() == 4 ? "" : c.f_utf8));
+
+                    // an odd number of bytes is truncated too
+                    //
+                    out = buffer.data();
+                    CATCH_REQUIRE(basic_xml::convert_utf16(text.data(), text.data() + text.length() - 1, big_endian, out, truncated) == text.data() + text.length() - 2);
+                    CATCH_REQUIRE(truncated);
+                }
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("scan: invalid UTF-16 surrogates")
+    {
+        // a low surrogate alone, a high surrogate followed by another
+        // high surrogate, and a high surrogate followed by a character
+        //
+        std::string const sequences[] =
+        {
+            std::string("\x00\xDC", 2),
+            std::string("\x00\xD8\x00\xD8", 4),
+            std::string("\x00\xD8" "a\0", 4),
+        };
+        for(auto const & seq : sequences)
+        {
+            for(std::size_t pos(0); pos < 40; ++pos)
+            {
+                std::string text;
+                for(std::size_t idx(0); idx < pos; ++idx)
+                {
+                    text += std::string("b\0", 2);
+                }
+                text += seq;
+                for(std::size_t idx(0); idx < 40; ++idx)
+                {
+                    text += std::string("b\0", 2);
+                }
+                std::string buffer(text.length() / 2 * 3, '\0');
+                char * out(buffer.data());
+                bool truncated(true);
+                CATCH_REQUIRE(basic_xml::convert_utf16(text.data(), text.data() + text.length(), false, out, truncated) == text.data() + pos * 2);
+                CATCH_REQUIRE_FALSE(truncated);
+                CATCH_REQUIRE(std::string(buffer.data(), out) == std::string(pos, 'b'));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,412 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/snapshot.h>
+
+#include    <basic-xml/exception.h>
+#include    <basic-xml/xml.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <fstream>
+#include    <sstream>
+
+
+// C
+//
+#include    <string.h>
+
+
+// zlib
+//
+#include    <zlib.h>
+
+
+
+namespace
+{
+
+
+
+char const g_document[] =
+    "<?xml version=\"1.0\"?>\n"
+    "<config version=\"3\" name=\"main\">\n"
+    "  <server host=\"localhost\" port=\"8080\">  primary  </server>\n"
+    "  <server host=\"backup\" port=\"8080\">secondary</server>\n"
+    "  <empty/>\n"
+    "  <nested><a><b><c>deep &amp; deeper</c></b></a></nested>\n"
+    "</config>\n";
+
+
+// the snapshot data has to be aligned, a string is not
+//
+class aligned_buffer
+{
+public:
+    aligned_buffer(std::string const & data)
+        : f_buffer((data.length() + 3) / 4)
+        , f_size(data.length())
+    {
+        memcpy(f_buffer.data(), data.data(), data.length());
+    }
+
+    char * data()
+    {
+        return reinterpret_cast<char *>(f_buffer.data());
+    }
+
+    std::size_t size() const
+    {
+        return f_size;
+    }
+
+private:
+    std::vector<std::uint32_t>  f_buffer;
+    std::size_t                 f_size;
+};
+
+
+std::string compile(std::string const & document)
+{
+    std::stringstream in;
+    in << document;
+    basic_xml::xml x("snapshot.xml", in);
+
+    std::stringstream out;
+    basic_xml::write_snapshot(out, *x.root());
+    return out.str();
+}
+
+
+void update_checksum(aligned_buffer & buffer)
+{
+    std::uint32_t const crc(crc32(
+              0
+            , reinterpret_cast<Bytef const *>(buffer.data() + 32)
+            , buffer.size() - 32));
+    memcpy(buffer.data() + 24, &crc, sizeof(crc));
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("snapshot", "[snapshot][valid]")
+{
+    CATCH_START_SECTION("snapshot: elements, attributes and text")
+    {
+        aligned_buffer buffer(compile(g_document));
+        basic_xml::snapshot s(buffer.data(), buffer.size());
+        CATCH_REQUIRE(s.size() == 8);
+
+        basic_xml::snapshot::element const root(s.root());
+        CATCH_REQUIRE(root);
+        CATCH_REQUIRE(root.tag_name() == "config");
+        CATCH_REQUIRE_FALSE(root.parent());
+        CATCH_REQUIRE_FALSE(root.next());
+        CATCH_REQUIRE(root.attribute_count() == 2);
+        CATCH_REQUIRE(root.attribute_name(0) == "name");
+        CATCH_REQUIRE(root.attribute_value(0) == "main");
+        CATCH_REQUIRE(root.attribute_name(1) == "version");
+        CATCH_REQUIRE(root.attribute_value(1) == "3");
+        CATCH_REQUIRE(root.attribute("version") == "3");
+        CATCH_REQUIRE(root.attribute("missing").empty());
+        CATCH_REQUIRE(root.text().empty());
+
+        basic_xml::snapshot::element const primary(root.first_child());
+        CATCH_REQUIRE(primary.tag_name() == "server");
+        CATCH_REQUIRE(primary.parent() == root);
+        CATCH_REQUIRE(primary.attribute("host") == "localhost");
+        CATCH_REQUIRE(primary.attribute("port") == "8080");
+        CATCH_REQUIRE(primary.attribute("a").empty());
+        CATCH_REQUIRE(primary.attribute("z").empty());
+        CATCH_REQUIRE(primary.text() == "primary");
+        CATCH_REQUIRE(primary.text(false) == "  primary  ");
+        CATCH_REQUIRE_FALSE(primary.first_child());
+
+        basic_xml::snapshot::element const secondary(primary.next());
+        CATCH_REQUIRE(secondary != primary);
+        CATCH_REQUIRE(secondary.tag_name() == "server");
+        CATCH_REQUIRE(secondary.attribute("host") == "backup");
+        CATCH_REQUIRE(secondary.text() == "secondary");
+
+        basic_xml::snapshot::element const empty(secondary.next());
+        CATCH_REQUIRE(empty.tag_name() == "empty");
+        CATCH_REQUIRE(empty.attribute_count() == 0);
+        CATCH_REQUIRE(empty.text().empty());
+
+        basic_xml::snapshot::element const nested(empty.next());
+        CATCH_REQUIRE(nested.tag_name() == "nested");
+        CATCH_REQUIRE_FALSE(nested.next());
+        basic_xml::snapshot::element const c(nested.first_child().first_child().first_child());
+        CATCH_REQUIRE(c.tag_name() == "c");
+        CATCH_REQUIRE(c.text() == "deep & deeper");
+        CATCH_REQUIRE(c.parent().parent().parent() == nested);
+
+        CATCH_REQUIRE_THROWS_AS(root.attribute_name(2), basic_xml::out_of_range);
+        CATCH_REQUIRE_THROWS_AS(root.attribute_value(2), basic_xml::out_of_range);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot: convert back to a tree")
+    {
+        std::stringstream in;
+        in << g_document;
+        basic_xml::xml x("tree.xml", in);
+        std::stringstream expected;
+        expected << *x.root();
+
+        aligned_buffer buffer(compile(g_document));
+        basic_xml::snapshot s(buffer.data(), buffer.size());
+        std::stringstream result;
+        result << *s.to_tree();
+        CATCH_REQUIRE(result.str() == expected.str());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot: load from a file")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/large.bxs");
+
+        std::string document("<root>");
+        for(int idx(0); idx < 1000; ++idx)
+        {
+            document += "<item id='" + std::to_string(idx) + "' type='number'>" + std::to_string(idx * 3) + "</item>";
+        }
+        document += "</root>";
+        {
+            std::ofstream out(filename, std::ios::binary);
+            CATCH_REQUIRE(out.is_open());
+            out << compile(document);
+        }
+
+        basic_xml::snapshot s(filename);
+        CATCH_REQUIRE(s.size() == 1001);
+        int idx(0);
+        for(basic_xml::snapshot::element e(s.root().first_child()); e; e = e.next(), ++idx)
+        {
+            CATCH_REQUIRE(e.tag_name() == "item");
+            CATCH_REQUIRE(e.attribute("id") == std::to_string(idx));
+            CATCH_REQUIRE(e.attribute("type") == "number");
+            CATCH_REQUIRE(e.text() == std::to_string(idx * 3));
+        }
+        CATCH_REQUIRE(idx == 1000);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("snapshot_errors", "[snapshot][invalid]")
+{
+    CATCH_START_SECTION("snapshot_errors: file not found")
+    {
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::snapshot("/this/file/does/not/exist.bxs")
+                , basic_xml::file_not_found);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: too small")
+    {
+        aligned_buffer buffer(compile("<root></root>"));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::snapshot(buffer.data(), 31)
+                , basic_xml::invalid_snapshot
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: snapshot: too small to be a snapshot."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: not aligned")
+    {
+        std::string const data(compile("<root></root>"));
+        std::vector<std::uint32_t> buffer(data.length() / 4 + 2);
+        char * misaligned(reinterpret_cast<char *>(buffer.data()) + 1);
+        memcpy(misaligned, data.data(), data.length());
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::snapshot(misaligned, data.length())
+                , basic_xml::invalid_snapshot
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: snapshot: the snapshot data is not properly aligned."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: not a snapshot")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/not-a-snapshot.xml");
+        {
+            std::ofstream out(filename);
+            CATCH_REQUIRE(out.is_open());
+            out << g_document;
+        }
+
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::snapshot(filename)
+                , basic_xml::invalid_snapshot
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: " + filename + ": not a snapshot."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: unsupported version")
+    {
+        aligned_buffer buffer(compile("<root></root>"));
+        ++buffer.data()[4];
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::snapshot(buffer.data(), buffer.size())
+                , basic_xml::invalid_snapshot
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: snapshot: unsupported snapshot version 2."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: size does not match")
+    {
+        std::string const data(compile("<root a='1'>text</root>"));
+        for(std::size_t const size : { data.length() - 1, data.length() + 4 })
+        {
+            aligned_buffer buffer(data + std::string(4, '\0'));
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), size)
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: the size of the snapshot does not match its header."));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: damaged data")
+    {
+        std::string const data(compile("<root a='1'><sub>text</sub></root>"));
+        for(std::size_t pos(32); pos < data.length(); ++pos)
+        {
+            aligned_buffer buffer(data);
+            buffer.data()[pos] ^= 0x40;
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), buffer.size())
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: invalid snapshot checksum."));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: invalid records with a valid checksum")
+    {
+        std::string const data(compile("<root a='1'><sub>text</sub></root>"));
+
+        // the parent of the root (element 0) is set to itself
+        {
+            aligned_buffer buffer(data);
+            memset(buffer.data() + 32 + 16, 0, 4);
+            update_checksum(buffer);
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), buffer.size())
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: element 0 of the snapshot is invalid."));
+        }
+
+        // the first child of "sub" (element 1) loops back to the root
+        {
+            aligned_buffer buffer(data);
+            memset(buffer.data() + 32 + 36 + 20, 0, 4);
+            update_checksum(buffer);
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), buffer.size())
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: element 1 of the snapshot is invalid."));
+        }
+
+        // the value of attribute 0 goes past the string table
+        {
+            aligned_buffer buffer(data);
+            std::uint32_t const length(1000);
+            memcpy(buffer.data() + 32 + 36 * 2 + 12, &length, sizeof(length));
+            update_checksum(buffer);
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), buffer.size())
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: attribute 0 of the snapshot is invalid."));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("snapshot_errors: invalid links with a valid checksum")
+    {
+        std::string const data(compile("<root><a/><b/></root>"));
+
+        // the first child of the root is "b" (element 2) which is also
+        // the next sibling of "a" (element 1)
+        {
+            aligned_buffer buffer(data);
+            std::uint32_t const child(2);
+            memcpy(buffer.data() + 32 + 20, &child, sizeof(child));
+            update_checksum(buffer);
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), buffer.size())
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: element 1 of the snapshot is invalid."));
+        }
+
+        // the parent of "b" (element 2) is "a" instead of the root
+        {
+            aligned_buffer buffer(data);
+            std::uint32_t const parent(1);
+            memcpy(buffer.data() + 32 + 36 * 2 + 16, &parent, sizeof(parent));
+            update_checksum(buffer);
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), buffer.size())
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: element 1 of the snapshot is invalid."));
+        }
+
+        // "a" (element 1) has no next sibling so "b" is not reachable
+        {
+            aligned_buffer buffer(data);
+            memset(buffer.data() + 32 + 36 + 24, 0xFF, 4);
+            update_checksum(buffer);
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::snapshot(buffer.data(), buffer.size())
+                    , basic_xml::invalid_snapshot
+                    , Catch::Matchers::ExceptionMessage(
+                              "xml_error: snapshot: element 2 of the snapshot is not attached to the tree."));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
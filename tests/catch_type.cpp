@@ -207,6 +207,22 @@ CATCH_TEST_CASE("types", "[type][valid]")
         }
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("types: is_token() with UTF-8")
+    {
+        CATCH_REQUIRE(basic_xml::is_token("caf\xC3\xA9"));                    // café
+        CATCH_REQUIRE(basic_xml::is_token("\xC3\xA9t\xC3\xA9"));              // été
+        CATCH_REQUIRE(basic_xml::is_token("\xE6\x97\xA5\xE6\x9C\xAC"));     // 日本
+        CATCH_REQUIRE(basic_xml::is_token("a\xF0\x90\x80\x80"));             // U+10000
+        CATCH_REQUIRE(basic_xml::is_token("a\xCC\x80"));                      // U+0300 (not a start char)
+
+        std::string const buffer("name-one name-two");
+        CATCH_REQUIRE(basic_xml::is_token(buffer.data(), 8));
+        CATCH_REQUIRE(basic_xml::is_token(buffer.data() + 9, 8));
+        CATCH_REQUIRE_FALSE(basic_xml::is_token(buffer.data(), buffer.length()));
+        CATCH_REQUIRE_FALSE(basic_xml::is_token(buffer.data(), 0));
+    }
+    CATCH_END_SECTION()
 }
 
 
@@ -219,6 +235,19 @@ CATCH_TEST_CASE("invalid_tokens", "[type][invalid]")
     }
     CATCH_END_SECTION()
 
+    CATCH_START_SECTION("invalid_tokens: is_token -- invalid UTF-8")
+    {
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("\xCC\x80"));                  // U+0300 is not a start char
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("caf\xC3"));                   // truncated
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("caf\xC3\x28"));               // bad continuation
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("a\xC0\x80"));                 // overlong
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("a\xED\xA0\x80"));             // surrogate
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("a\xF4\x90\x80\x80"));         // over U+10FFFF
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("a\x80"));                     // continuation without lead
+        CATCH_REQUIRE_FALSE(basic_xml::is_token("a\xFF"));
+    }
+    CATCH_END_SECTION()
+
     CATCH_START_SECTION("invalid_tokens: is_token -- 1st must be alpha")
     {
         for(char32_t c(1); c < 0x110000; ++c)
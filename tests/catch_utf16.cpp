@@ -0,0 +1,319 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/utf16.h>
+
+#include    <basic-xml/exception.h>
+#include    <basic-xml/push_parser.h>
+#include    <basic-xml/xml.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// libutf8
+//
+#include    <libutf8/libutf8.h>
+
+
+// C++
+//
+#include    <fstream>
+#include    <sstream>
+
+
+
+namespace
+{
+
+
+
+std::u32string generate_document(std::size_t count)
+{
+    std::u32string doc(U"<?xml version=\"1.0\" encoding=\"UTF-16\"?>\n<feed>\n");
+    for(std::size_t idx(0); idx < count; ++idx)
+    {
+        std::string const number(std::to_string(idx));
+        doc += U"  <item id=\"" + std::u32string(number.begin(), number.end()) + U"\">";
+        doc += U"Café € \U0001F600 &amp; plain ASCII text";
+        doc += U"</item>\n";
+    }
+    doc += U"</feed>\n";
+    return doc;
+}
+
+
+std::string to_utf16(std::u32string const & doc, bool big_endian, bool bom = true)
+{
+    std::string result;
+    auto const add = [&result, big_endian](char32_t unit)
+    {
+        char const high(static_cast<char>(unit >> 8));
+        char const low(static_cast<char>(unit & 0xFF));
+        result += big_endian ? high : low;
+        result += big_endian ? low : high;
+    };
+    if(bom)
+    {
+        add(0xFEFF);
+    }
+    for(char32_t const c : doc)
+    {
+        if(c >= 0x10000)
+        {
+            add(0xD800 + ((c - 0x10000) >> 10));
+            add(0xDC00 + ((c - 0x10000) & 0x3FF));
+        }
+        else
+        {
+            add(c);
+        }
+    }
+    return result;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("utf16", "[utf16][valid]")
+{
+    CATCH_START_SECTION("utf16: detect the byte order mark")
+    {
+        CATCH_REQUIRE(basic_xml::is_utf16("\xFF\xFE", 2));
+        CATCH_REQUIRE(basic_xml::is_utf16("\xFE\xFF<", 3));
+        CATCH_REQUIRE_FALSE(basic_xml::is_utf16("\xFF", 1));
+        CATCH_REQUIRE_FALSE(basic_xml::is_utf16("\xFE\xFE", 2));
+        CATCH_REQUIRE_FALSE(basic_xml::is_utf16("\xEF\xBB\xBF", 3));
+        CATCH_REQUIRE_FALSE(basic_xml::is_utf16("<root/>", 7));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("utf16: little and big endian give the same tree as UTF-8")
+    {
+        // large enough for the surrogates to be cut between blocks
+        //
+        std::u32string const doc(generate_document(5'000));
+        std::string const utf8(libutf8::to_u8string(doc));
+        basic_xml::xml original("feed.xml", std::string_view(utf8));
+        std::string const expected(SNAP_CATCH2_NAMESPACE::to_string(original.root()));
+
+        for(bool const big_endian : { false, true })
+        {
+            std::string const utf16(to_utf16(doc, big_endian));
+
+            // from memory
+            //
+            basic_xml::xml x("feed.xml", std::string_view(utf16));
+            CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(x.root()) == expected);
+
+            // from a file
+            //
+            std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+            std::string const filename(xml_path + "/feed-utf16.xml");
+            {
+                std::ofstream f(filename, std::ios::binary);
+                CATCH_REQUIRE(f.is_open());
+                f << utf16;
+            }
+            basic_xml::xml y(filename);
+            CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(y.root()) == expected);
+
+            basic_xml::xml z(filename, 4);
+            CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(z.root()) == expected);
+
+            // from a stream
+            //
+            std::stringstream in(utf16);
+            basic_xml::utf16_istream u(in);
+            basic_xml::xml w("feed.xml", u);
+            CATCH_REQUIRE(SNAP_CATCH2_NAMESPACE::to_string(w.root()) == expected);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("utf16: convert every character length at every position")
+    {
+        std::u32string const characters[] =
+        {
+            U"A",
+            U"é",
+            U"߿",
+            U"ࠀ",
+            U"퟿",
+            U"",
+            U"�",
+            U"\U00010000",
+            U"\U0010FFFF",
+        };
+        for(auto const & c : characters)
+        {
+            for(std::size_t pos(0); pos < 40; ++pos)
+            {
+                std::u32string const text(std::u32string(pos, U'a') + c + std::u32string(40, U'b'));
+                std::string const utf16(to_utf16(text, pos % 2 == 0));
+                basic_xml::utf16_istream u(utf16.data(), utf16.size());
+                std::stringstream out;
+                out << u.rdbuf();
+                CATCH_REQUIRE(out.str() == libutf8::to_u8string(text));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("utf16: UTF-8 byte order mark")
+    {
+        std::string const doc("\xEF\xBB\xBF<?xml version=\"1.0\"?><root a='1'>text</root>");
+
+        basic_xml::xml x("bom.xml", std::string_view(doc));
+        CATCH_REQUIRE(x.root()->tag_name() == "root");
+        CATCH_REQUIRE(x.root()->text() == "text");
+
+        std::stringstream in(doc);
+        basic_xml::xml y("bom.xml", in);
+        CATCH_REQUIRE(y.root()->attribute("a") == "1");
+
+        // the push parser may receive the mark one byte at a time
+        //
+        basic_xml::push_parser p("bom.xml");
+        for(char const c : doc)
+        {
+            p.feed(&c, 1);
+        }
+        p.finish();
+        CATCH_REQUIRE(p.root()->tag_name() == "root");
+
+        // a character starting with 0xEF which is not the mark
+        //
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("bom.xml", std::string_view("\xEF\xBB\xBE<root/>"))
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: bom.xml:1:2: cannot include text data before or after the root tag."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("utf16_errors", "[utf16][invalid]")
+{
+    CATCH_START_SECTION("utf16_errors: the mark does not count in the column")
+    {
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("bom.xml", std::string_view("\xEF\xBB\xBF<root></toor>"))
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: bom.xml:1:14: unexpected token \"toor\" in this closing tag; expected \"root\" instead."));
+
+        std::string const utf16(to_utf16(U"<root></toor>", false));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("utf16.xml", std::string_view(utf16))
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: utf16.xml:1:14: unexpected token \"toor\" in this closing tag; expected \"root\" instead."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("utf16_errors: missing byte order mark")
+    {
+        std::string const utf16(to_utf16(U"<root></root>", false, false));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::utf16_istream(utf16.data(), utf16.size())
+                , basic_xml::invalid_utf16
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: UTF-16 data must start with a byte order mark."));
+
+        std::stringstream in(utf16);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::utf16_istream(in)
+                , basic_xml::invalid_utf16
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: UTF-16 data must start with a byte order mark."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("utf16_errors: invalid surrogates")
+    {
+        for(bool const big_endian : { false, true })
+        {
+            // a low surrogate alone and a high surrogate followed by 'a'
+            //
+            for(std::u32string const & bad : { std::u32string(1, 0xDC00), std::u32string{ 0xD800, U'a' } })
+            {
+                std::string utf16(to_utf16(U"<root>", big_endian));
+                for(char32_t const c : bad)
+                {
+                    utf16 += big_endian ? static_cast<char>(c >> 8) : static_cast<char>(c & 0xFF);
+                    utf16 += big_endian ? static_cast<char>(c & 0xFF) : static_cast<char>(c >> 8);
+                }
+                utf16 += to_utf16(U"</root>", big_endian, false);
+                CATCH_REQUIRE_THROWS_MATCHES(
+                          basic_xml::xml("surrogate.xml", std::string_view(utf16))
+                        , basic_xml::invalid_utf16
+                        , Catch::Matchers::ExceptionMessage(
+                                  "xml_error: invalid UTF-16 surrogate found at byte offset 14."));
+            }
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("utf16_errors: truncated data")
+    {
+        std::string const utf16(to_utf16(U"<root>\U0001F600</root>", false));
+
+        // cut in the middle of a code unit
+        //
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("truncated.xml", std::string_view(utf16.data(), utf16.size() - 1))
+                , basic_xml::invalid_utf16
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: the UTF-16 data ends in the middle of a character."));
+
+        // cut between the two surrogates
+        //
+        std::stringstream in(utf16.substr(0, 16));
+        basic_xml::utf16_istream u(in);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("truncated.xml", u)
+                , basic_xml::invalid_utf16
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: the UTF-16 data ends in the middle of a character."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("utf16_errors: UTF-16 read as UTF-8")
+    {
+        std::stringstream in(to_utf16(U"<root></root>", true));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("stream.xml", in)
+                , basic_xml::invalid_utf8
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: stream.xml: the input is UTF-16, read it through a utf16_istream."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -0,0 +1,220 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/validate.h>
+
+#include    <basic-xml/exception.h>
+#include    <basic-xml/xml.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <fstream>
+#include    <sstream>
+
+
+
+namespace
+{
+
+
+
+// the validation has to accept and reject the exact same documents as
+// the xml object, with the same error messages
+//
+std::string xml_error_message(std::string const & document)
+{
+    try
+    {
+        std::stringstream ss;
+        ss << document;
+        basic_xml::xml x("compare.xml", ss);
+    }
+    catch(basic_xml::xml_error const & e)
+    {
+        return e.what();
+    }
+    return std::string();
+}
+
+
+std::string validate_error_message(std::string const & document)
+{
+    try
+    {
+        std::stringstream ss;
+        ss << document;
+        basic_xml::validate("compare.xml", ss);
+    }
+    catch(basic_xml::xml_error const & e)
+    {
+        return e.what();
+    }
+    return std::string();
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("validate", "[validate][valid]")
+{
+    CATCH_START_SECTION("validate: valid stream")
+    {
+        std::stringstream ss;
+        ss << "<?xml version=\"1.0\"?>\n"
+              "<!-- comment -->\n"
+              "<root lang=\"en\">\n"
+              "  <title>A &amp; B &#x263A;</title>\n"
+              "  <data><![CDATA[<raw>]]></data>\n"
+              "  <empty with='attribute'/>\n"
+              "</root>\n";
+        basic_xml::validate("valid.xml", ss);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("validate: valid file")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/validate.xml");
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << "<root>";
+            for(int idx(0); idx < 1000; ++idx)
+            {
+                f << "<item id='" << idx << "'>text " << idx << "</item>\n";
+            }
+            f << "</root>";
+        }
+
+        basic_xml::validate(filename);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("validate: valid data in memory")
+    {
+        std::string const data("<root><item a='1'>text &lt; more</item></root>");
+        basic_xml::validate("memory.xml", data);
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::validate("memory.xml", std::string_view(data).substr(0, data.length() - 1))
+                , basic_xml::unexpected_eof);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("validate: same result as the xml object")
+    {
+        std::string const documents[] =
+        {
+            "<root/>",
+            "<root a='1' b=\"2\">text</root>",
+            "",
+            "<root>",
+            "<root></wrong>",
+            "<root><a><b></a></b></root>",
+            "<root/><second/>",
+            "<root a='1' a='2'/>",
+            "<root -a='1'/>",
+            "<root 1a='1'/>",
+            "<root>&unknown;</root>",
+            "<root a='&#0;'/>",
+            "<root>text > more</root>",
+            "text<root/>",
+            "<root><!-- comment --></root>",
+            "<root><!-- unterminated comment </root>",
+        };
+        for(auto const & doc : documents)
+        {
+            CATCH_REQUIRE(validate_error_message(doc) == xml_error_message(doc));
+        }
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("validate_errors", "[validate][invalid]")
+{
+    CATCH_START_SECTION("validate_errors: tags do not match")
+    {
+        std::stringstream ss;
+        std::string const filename("mismatch.xml");
+        ss << "<root>\n  <this>text</that>\n</root>";
+
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::validate(filename, ss)
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":2:20: unexpected token \"that\" in this closing tag; expected \"this\" instead."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("validate_errors: invalid attribute name")
+    {
+        std::stringstream ss;
+        ss << "<root><sub -name='value'/></root>";
+
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::validate("attribute.xml", ss)
+                , basic_xml::invalid_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: \"-name\" is not a valid token for an attribute name."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("validate_errors: limits apply")
+    {
+        std::stringstream ss;
+        std::string const filename("deep.xml");
+        ss << "<a><b><c><d/></c></b></a>";
+
+        basic_xml::parse_options options;
+        options.f_max_depth = 3;
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::validate(filename, ss, options)
+                , basic_xml::limit_exceeded
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:12: nesting depth (4) is over the limit of 3."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("validate_errors: file not found")
+    {
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::validate("/this/file/does/not/exist.xml")
+                , basic_xml::file_not_found);
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
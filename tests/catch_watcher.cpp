@@ -0,0 +1,226 @@
+// Copyright (c) 2019-2024  Made to Order Software Corp.  All Rights Reserved
+//
+// https://snapwebsites.org/project/basic-xml
+// contact@m2osw.com
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+// basic-xml
+//
+#include    <basic-xml/watcher.h>
+
+#include    <basic-xml/exception.h>
+
+
+// self
+//
+#include    "catch_main.h"
+
+
+// C++
+//
+#include    <filesystem>
+#include    <mutex>
+
+
+
+namespace
+{
+
+
+
+std::string watcher_path()
+{
+    std::string const path(SNAP_CATCH2_NAMESPACE::get_folder_name() + "/watcher");
+    std::filesystem::create_directories(path);
+    return path;
+}
+
+
+// the reload happens in another thread, give it some time
+//
+template<typename F>
+bool wait_for(F condition)
+{
+    for(int count(0); count < 500; ++count)
+    {
+        if(condition())
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("watcher", "[watcher][valid][thread]")
+{
+    CATCH_START_SECTION("watcher: reload after changes")
+    {
+        std::string const path(watcher_path());
+        std::string const filename(path + "/config.xml");
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>1</value></config>");
+
+        std::mutex mutex;
+        std::vector<std::string> errors;
+        basic_xml::watcher w(
+                  filename
+                , [&mutex, &errors](std::string const & name, std::string const & message)
+                  {
+                      std::lock_guard<std::mutex> lock(mutex);
+                      errors.push_back(name + ": " + message);
+                  });
+        CATCH_REQUIRE(w.version() == 1);
+        basic_xml::node::pointer_t const first(w.root());
+        CATCH_REQUIRE(first->first_child()->text() == "1");
+
+        // written in place
+        //
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>2</value></config>");
+        CATCH_REQUIRE(wait_for([&w]() { return w.version() == 2; }));
+        CATCH_REQUIRE(w.root()->first_child()->text() == "2");
+
+        // the readers still holding the old tree can still use it
+        //
+        CATCH_REQUIRE(first->first_child()->text() == "1");
+
+        // other files in the same directory are ignored
+        //
+        SNAP_CATCH2_NAMESPACE::write_file(path + "/other.xml", "<other></other>");
+
+        // renamed over the old file
+        //
+        SNAP_CATCH2_NAMESPACE::write_file(path + "/config.xml.tmp", "<config><value>3</value></config>");
+        std::filesystem::rename(path + "/config.xml.tmp", filename);
+        CATCH_REQUIRE(wait_for([&w]() { return w.version() == 3; }));
+        CATCH_REQUIRE(w.root()->first_child()->text() == "3");
+
+        std::lock_guard<std::mutex> lock(mutex);
+        CATCH_REQUIRE(errors.empty());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("watcher: invalid versions keep the previous root")
+    {
+        std::string const filename(watcher_path() + "/invalid.xml");
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>valid</value></config>");
+
+        std::mutex mutex;
+        std::vector<std::string> errors;
+        basic_xml::watcher w(
+                  filename
+                , [&mutex, &errors](std::string const & name, std::string const & message)
+                  {
+                      std::lock_guard<std::mutex> lock(mutex);
+                      errors.push_back(name + ": " + message);
+                  });
+
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>broken</config>");
+        CATCH_REQUIRE(wait_for([&mutex, &errors]()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return !errors.empty();
+            }));
+        CATCH_REQUIRE(w.version() == 1);
+        CATCH_REQUIRE(w.root()->first_child()->text() == "valid");
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            CATCH_REQUIRE(errors[0] ==
+                      filename
+                    + ": xml_error: "
+                    + filename
+                    + ":1:31: unexpected token \"config\" in this closing tag; expected \"value\" instead.");
+        }
+
+        // once fixed, the new version gets loaded
+        //
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>fixed</value></config>");
+        CATCH_REQUIRE(wait_for([&w]() { return w.version() == 2; }));
+        CATCH_REQUIRE(w.root()->first_child()->text() == "fixed");
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("watcher_errors", "[watcher][invalid]")
+{
+    CATCH_START_SECTION("watcher_errors: the first version must be valid")
+    {
+        std::string const filename(watcher_path() + "/first.xml");
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config>");
+
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::watcher(filename)
+                , basic_xml::unexpected_token);
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::watcher(watcher_path() + "/missing.xml")
+                , basic_xml::file_not_found);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("watcher_errors: the directory gets removed")
+    {
+        std::string const path(watcher_path() + "/removed");
+        std::filesystem::create_directories(path);
+        std::string const filename(path + "/config.xml");
+        SNAP_CATCH2_NAMESPACE::write_file(filename, "<config><value>kept</value></config>");
+
+        std::mutex mutex;
+        std::vector<std::string> errors;
+        basic_xml::watcher w(
+                  filename
+                , [&mutex, &errors](std::string const & name, std::string const & message)
+                  {
+                      std::lock_guard<std::mutex> lock(mutex);
+                      errors.push_back(name + ": " + message);
+                  });
+
+        std::filesystem::remove_all(path);
+        CATCH_REQUIRE(wait_for([&mutex, &errors]()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                return !errors.empty();
+            }));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            CATCH_REQUIRE(errors.size() == 1);
+            CATCH_REQUIRE(errors[0] ==
+                      filename
+                    + ": the directory was removed or unmounted; the file is not watched anymore.");
+        }
+        CATCH_REQUIRE(w.version() == 1);
+        CATCH_REQUIRE(w.root()->first_child()->text() == "kept");
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("watcher_errors: the directory must exist")
+    {
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::watcher("/this/directory/does/not/exist.xml")
+                , basic_xml::io_error
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: could not watch directory \"/this/directory/does/not\": No such file or directory."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+
+// vim: ts=4 sw=4 et
@@ -21,6 +21,7 @@
 #include    <basic-xml/xml.h>
 
 #include    <basic-xml/exception.h>
+#include    <basic-xml/push_parser.h>
 
 
 // self
@@ -30,7 +31,9 @@
 
 // C++
 //
+#include    <algorithm>
 #include    <fstream>
+#include    <sstream>
 
 
 
@@ -187,11 +190,61 @@ CATCH_TEST_CASE("xml", "[xml][valid]")
         CATCH_REQUIRE(root->previous() == nullptr);
     }
     CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml: load from memory")
+    {
+        // the view does not need to end with a '\0'; here it is a part
+        // of a larger buffer
+        //
+        std::string const buffer(
+                  "garbage before"
+                  "<?xml version=\"1.0\"?>\n"
+                  "<memory size='12'><item>one &amp; two</item><item/></memory>"
+                  "<garbage after");
+        std::string_view const data(std::string_view(buffer).substr(14, buffer.length() - 14 - 14));
+
+        basic_xml::xml x("memory.xml", data);
+        basic_xml::node::pointer_t root(x.root());
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->tag_name() == "memory");
+        CATCH_REQUIRE(root->attribute("size") == "12");
+        CATCH_REQUIRE(root->first_child()->text() == "one & two");
+        CATCH_REQUIRE(root->last_child()->tag_name() == "item");
+
+        // same tree as with a stream
+        //
+        std::stringstream ss;
+        ss << data;
+        basic_xml::xml y("memory.xml", ss);
+        std::stringstream expected;
+        expected << *y.root();
+        std::stringstream result;
+        result << *root;
+        CATCH_REQUIRE(result.str() == expected.str());
+
+        // options apply
+        //
+        basic_xml::parse_options options;
+        options.f_decode = basic_xml::decode_t::DECODE_LAZY;
+        basic_xml::xml z("memory.xml", data, options);
+        CATCH_REQUIRE(z.root()->first_child()->text() == "one & two");
+    }
+    CATCH_END_SECTION()
 }
 
 
 CATCH_TEST_CASE("xml_errors", "[xml][invalid]")
 {
+    CATCH_START_SECTION("xml_errors: error in memory")
+    {
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("payload", std::string_view("<root>\n  <a></b>\n</root>"))
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: payload:2:10: unexpected token \"b\" in this closing tag; expected \"a\" instead."));
+    }
+    CATCH_END_SECTION()
+
     CATCH_START_SECTION("xml_errors: file missing")
     {
         std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
@@ -243,7 +296,21 @@ CATCH_TEST_CASE("xml_errors", "[xml][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
+                        + ":1:1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_errors: parse empty device (cannot be mapped)")
+    {
+        std::string const filename("/dev/null");
+
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml(filename)
+                , basic_xml::unexpected_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":1:1: cannot be empty or include anything other than a processor tag and comments before the root tag.", true));
     }
     CATCH_END_SECTION()
 
@@ -261,7 +328,506 @@ CATCH_TEST_CASE("xml_errors", "[xml][invalid]")
                 , Catch::Matchers::ExceptionMessage(
                           "xml_error: "
                         + filename
-                        + ":1: root tag cannot be an empty tag.", true));
+                        + ":1:9: root tag cannot be an empty tag.", true));
+    }
+    CATCH_END_SECTION()
+}
+
+
+namespace
+{
+
+
+
+std::string generate_large_document(std::size_t count)
+{
+    std::stringstream ss;
+    ss << "<?xml version=\"1.0\"?>\n"
+          "<!-- large document -->\n"
+          "<records count=\"" << count << "\">\n";
+    for(std::size_t idx(0); idx < count; ++idx)
+    {
+        switch(idx % 5)
+        {
+        case 0:
+            ss << "  <record id=\"" << idx << "\">\n"
+                  "    <name>Record &#x23;" << idx << "</name>\n"
+                  "    <value type='int'>" << idx * 7 << "</value>\n"
+                  "  </record>\n";
+            break;
+
+        case 1:
+            // a CDATA section which looks like a start tag
+            //
+            ss << "  <record id=\"" << idx << "\"><data><![CDATA[<fake>\n"
+                  "<record id=\"-1\"> ]]></data></record>\n";
+            break;
+
+        case 2:
+            // a comment which looks like a start tag
+            //
+            ss << "  <!-- <record id=\"-2\"> -->\n"
+                  "  <record id=\"" << idx << "\"/>\n";
+            break;
+
+        case 3:
+            // nested tags which could be taken as a split point
+            //
+            ss << "  <record id=\"" << idx << "\">\n"
+                  "    <group><item/>\n"
+                  "      <item>" << idx << "</item>\n"
+                  "    </group>\n"
+                  "  </record>text " << idx << "\n";
+            break;
+
+        case 4:
+            ss << "  <note>&lt;record&gt; " << idx << "</note>\n";
+            break;
+
+        }
+    }
+    ss << "</records>\n"
+          "<!-- the end -->\n";
+    return ss.str();
+}
+
+
+
+} // no name namespace
+
+
+
+CATCH_TEST_CASE("xml_parallel", "[xml][valid][thread]")
+{
+    CATCH_START_SECTION("xml_parallel: large document gives the same tree")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/parallel.xml");
+
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << generate_large_document(50'000);
+        }
+
+        basic_xml::xml serial(filename);
+        std::stringstream expected;
+        expected << *serial.root();
+
+        for(std::size_t thread_count : { 0, 1, 2, 3, 4, 7, 16 })
+        {
+            basic_xml::xml x(filename, thread_count);
+            basic_xml::node::pointer_t root(x.root());
+            CATCH_REQUIRE(root != nullptr);
+            CATCH_REQUIRE(root->tag_name() == "records");
+            CATCH_REQUIRE(root->attribute("count") == "50000");
+
+            std::stringstream result;
+            result << *root;
+            CATCH_REQUIRE(result.str() == expected.str());
+
+            std::size_t count(0);
+            for(basic_xml::node::pointer_t child(root->first_child());
+                child != nullptr;
+                child = child->next())
+            {
+                CATCH_REQUIRE(child->parent() == root);
+                ++count;
+            }
+            CATCH_REQUIRE(count == 50'000);
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_parallel: small document")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/parallel-small.xml");
+
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << generate_large_document(10);
+        }
+
+        basic_xml::xml serial(filename);
+        basic_xml::xml x(filename, 8);
+        std::stringstream expected;
+        expected << *serial.root();
+        std::stringstream result;
+        result << *x.root();
+        CATCH_REQUIRE(result.str() == expected.str());
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_parallel: many children")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/parallel-flat.xml");
+
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << "<flat>";
+            for(int idx(0); idx < 500'000; ++idx)
+            {
+                f << "<i/>";
+            }
+            f << "</flat>";
+        }
+
+        basic_xml::xml x(filename, 4);
+        basic_xml::node::pointer_t root(x.root());
+        CATCH_REQUIRE(root->first_child() != nullptr);
+        CATCH_REQUIRE(root->first_child()->tag_name() == "i");
+        CATCH_REQUIRE(root->last_child() != nullptr);
+        CATCH_REQUIRE(root->last_child()->next() == nullptr);
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("xml_parallel_errors", "[xml][invalid][thread]")
+{
+    CATCH_START_SECTION("xml_parallel_errors: error near the end reports the same line")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/parallel-error.xml");
+
+        std::string doc(generate_large_document(50'000));
+        std::string::size_type const pos(doc.rfind("<note>"));
+        CATCH_REQUIRE(pos != std::string::npos);
+        doc.replace(pos, 6, "<=note>");
+        int const line(std::count(doc.begin(), doc.begin() + pos, '\n') + 1);
+
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << doc;
+        }
+
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml(filename)
+                , basic_xml::invalid_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":"
+                        + std::to_string(line)
+                        + ":5: character '=' is not valid for a tag name."));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml(filename, 4)
+                , basic_xml::invalid_token
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: "
+                        + filename
+                        + ":"
+                        + std::to_string(line)
+                        + ":5: character '=' is not valid for a tag name."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_parallel_errors: missing end tag")
+    {
+        std::string const xml_path(SNAP_CATCH2_NAMESPACE::get_folder_name());
+        std::string const filename(xml_path + "/parallel-unterminated.xml");
+
+        std::string doc(generate_large_document(50'000));
+        doc.resize(doc.rfind("</records>"));
+
+        {
+            std::ofstream f;
+            f.open(filename);
+            CATCH_REQUIRE(f.is_open());
+            f << doc;
+        }
+
+        std::string message;
+        try
+        {
+            basic_xml::xml x(filename);
+        }
+        catch(basic_xml::xml_error const & e)
+        {
+            message = e.what();
+        }
+        CATCH_REQUIRE_FALSE(message.empty());
+
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml(filename, 3)
+                , basic_xml::xml_error
+                , Catch::Matchers::ExceptionMessage(message));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("xml_lazy", "[xml][valid][lazy]")
+{
+    CATCH_START_SECTION("xml_lazy: same tree as with immediate decoding")
+    {
+        std::string const doc(
+                "<?xml version=\"1.0\"?>\n"
+                "<lazy a=\"&#x71;uit&#101;\" b='1&#x32;3' c=\"&quot;&lt;it&apos;s &amp; weird&gt;&quot;\" d=\"plain\">\n"
+                "  <item id=\"1\">Caf&#xE9; &amp; cr&#232;me</item>\n"
+                "  <item id=\"2\">a&amp;<!-- split -->b &amp<!-- more -->amp;</item>\n"
+                "  <item id=\"3\"><![CDATA[&amp; <raw>]]> &lt;</item>\n"
+                "  <empty flag='&lt;yes&gt;'/>\n"
+                "</lazy>\n");
+
+        std::stringstream now_in(doc);
+        basic_xml::xml now("lazy.xml", now_in);
+        std::stringstream lazy_in(doc);
+        basic_xml::xml lazy("lazy.xml", lazy_in, basic_xml::decode_t::DECODE_LAZY);
+
+        std::stringstream expected;
+        expected << *now.root();
+        std::stringstream result;
+        result << *lazy.root();
+        CATCH_REQUIRE(result.str() == expected.str());
+
+        std::stringstream again_in(doc);
+        basic_xml::xml again("lazy.xml", again_in, basic_xml::decode_t::DECODE_LAZY);
+        basic_xml::node::pointer_t root(again.root());
+        CATCH_REQUIRE(root->attribute("c") == "\"<it's & weird>\"");
+        CATCH_REQUIRE(root->attribute("d") == "plain");
+        CATCH_REQUIRE(root->attribute("missing") == "");
+
+        // the second access returns the cached value
+        //
+        CATCH_REQUIRE(root->attribute("c") == "\"<it's & weird>\"");
+        CATCH_REQUIRE(root->all_attributes().size() == 4);
+        CATCH_REQUIRE(root->all_attributes().at("c") == "\"<it's & weird>\"");
+        CATCH_REQUIRE(root->first_child()->text() == "Caf\xC3\xA9 & cr\xC3\xA8me");
+        CATCH_REQUIRE(root->first_child()->next()->text() == "a&b &ampamp;");
+
+        // modifying a lazy node keeps the other attributes
+        //
+        root->set_attribute("d", "changed");
+        root->set_attribute("e", "&amp;");
+        CATCH_REQUIRE(root->all_attributes().size() == 5);
+        CATCH_REQUIRE(root->attribute("a") == "quite");
+        CATCH_REQUIRE(root->attribute("b") == "123");
+        CATCH_REQUIRE(root->attribute("d") == "changed");
+        CATCH_REQUIRE(root->attribute("e") == "&amp;");
+
+        basic_xml::node::pointer_t empty(root->last_child());
+        CATCH_REQUIRE(empty->tag_name() == "empty");
+        empty->append_text("x &amp; y");
+        CATCH_REQUIRE(empty->text() == "x &amp; y");
+        CATCH_REQUIRE(empty->attribute("flag") == "<yes>");
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("xml_lazy_errors", "[xml][invalid][lazy]")
+{
+    CATCH_START_SECTION("xml_lazy_errors: invalid entities are reported on access")
+    {
+        std::stringstream ss;
+        ss << "<lazy bad=\"&unknown;\" good=\"yes\"><number>&#xD800;</number></lazy>";
+
+        basic_xml::xml x("lazy-errors.xml", ss, basic_xml::decode_t::DECODE_LAZY);
+        basic_xml::node::pointer_t root(x.root());
+        CATCH_REQUIRE(root->attribute("good") == "yes");
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  root->attribute("bad")
+                , basic_xml::invalid_entity
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: tag \"lazy\": unsupported entity (\"&unknown;\")."));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  root->all_attributes()
+                , basic_xml::invalid_entity
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: tag \"lazy\": unsupported entity (\"&unknown;\")."));
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  root->first_child()->text()
+                , basic_xml::invalid_number
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: tag \"number\": the number found in numeric entity, \"0xD800\", is not considered valid."));
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("xml_limits", "[xml][valid][limits]")
+{
+    CATCH_START_SECTION("xml_limits: document within all the limits")
+    {
+        std::stringstream ss;
+        ss << "<root a='1' b='2'><child>some text</child><child/></root>";
+
+        basic_xml::parse_options options;
+        options.f_max_depth = 2;
+        options.f_max_size = 100;
+        options.f_max_nodes = 3;
+        options.f_max_attributes = 2;
+        options.f_max_attribute_length = 1;
+        options.f_max_text_length = 9;
+        options.f_max_memory = 1024 * 1024;
+
+        basic_xml::xml x("limits.xml", ss, options);
+        basic_xml::node::pointer_t root(x.root());
+        CATCH_REQUIRE(root != nullptr);
+        CATCH_REQUIRE(root->attribute("b") == "2");
+        CATCH_REQUIRE(root->first_child()->text() == "some text");
+    }
+    CATCH_END_SECTION()
+}
+
+
+CATCH_TEST_CASE("xml_limits_errors", "[xml][invalid][limits]")
+{
+    CATCH_START_SECTION("xml_limits_errors: each limit raises limit_exceeded")
+    {
+        struct limit_test_t
+        {
+            std::size_t basic_xml::parse_options::*     f_limit = nullptr;
+            std::size_t                                 f_value = 0;
+            char const *                                f_xml = nullptr;
+            char const *                                f_message = nullptr;
+        };
+
+        limit_test_t const tests[] =
+        {
+            {
+                &basic_xml::parse_options::f_max_depth,
+                3,
+                "<a>\n<b>\n<c>\n<d/></c></b></a>",
+                "xml_error: limits.xml:4:3: nesting depth (4) is over the limit of 3.",
+            },
+            {
+                &basic_xml::parse_options::f_max_size,
+                20,
+                "<root>twenty one bytes</root>",
+                "xml_error: limits.xml:1:1: input size (29) is over the limit of 20.",
+            },
+            {
+                &basic_xml::parse_options::f_max_nodes,
+                3,
+                "<r><n/><n/>\n<n/></r>",
+                "xml_error: limits.xml:2:3: number of nodes (4) is over the limit of 3.",
+            },
+            {
+                &basic_xml::parse_options::f_max_attributes,
+                2,
+                "<r a='1' b='2' c='3'/>",
+                "xml_error: limits.xml:1:17: number of attributes (3) is over the limit of 2.",
+            },
+            {
+                &basic_xml::parse_options::f_max_attribute_length,
+                5,
+                "<r a='&lt;&lt;&lt;&lt;&lt;' b='&lt;&lt;&lt;&lt;&lt;&lt;'/>",
+                "xml_error: limits.xml:1:57: attribute length (6) is over the limit of 5.",
+            },
+            {
+                &basic_xml::parse_options::f_max_text_length,
+                10,
+                "<r>short<b/>a little longer</r>",
+                "xml_error: limits.xml:1:28: text length (15) is over the limit of 10.",
+            },
+        };
+
+        for(auto const & t : tests)
+        {
+            std::stringstream ss;
+            ss << t.f_xml;
+
+            basic_xml::parse_options options;
+            options.*t.f_limit = t.f_value;
+
+            CATCH_REQUIRE_THROWS_MATCHES(
+                      basic_xml::xml("limits.xml", ss, options)
+                    , basic_xml::limit_exceeded
+                    , Catch::Matchers::ExceptionMessage(t.f_message));
+        }
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_limits_errors: memory budget")
+    {
+        std::stringstream ss;
+        ss << "<root>";
+        for(int i(0); i < 10000; ++i)
+        {
+            ss << "<item name='item " << i << "'>text " << i << "</item>";
+        }
+        ss << "</root>";
+
+        basic_xml::parse_options options;
+        options.f_max_memory = 256 * 1024;
+
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::xml("memory.xml", ss, options)
+                , basic_xml::limit_exceeded);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_limits_errors: limit_exceeded is an xml_error")
+    {
+        std::stringstream ss;
+        ss << "<a><b><c/></b></a>";
+
+        basic_xml::parse_options options;
+        options.f_max_depth = 1;
+
+        CATCH_REQUIRE_THROWS_AS(
+                  basic_xml::xml("limits.xml", ss, options)
+                , basic_xml::xml_error);
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_limits_errors: push parser")
+    {
+        basic_xml::parse_options options;
+        options.f_max_depth = 2;
+
+        basic_xml::push_parser p("push-limits.xml", options);
+        p.feed("<a><b>", 6);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.feed("<c/></b></a>", 12)
+                , basic_xml::limit_exceeded
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: push-limits.xml:1:9: nesting depth (3) is over the limit of 2."));
+    }
+    CATCH_END_SECTION()
+
+    CATCH_START_SECTION("xml_limits_errors: truncated attribute value")
+    {
+        // the value never grows past the limits, the end of the input
+        // must still stop the parser
+        //
+        basic_xml::parse_options options;
+        options.f_max_size = 1024;
+        options.f_max_attribute_length = 16;
+        options.f_max_memory = 1024 * 1024;
+
+        std::string const truncated("<a b=\"xyz");
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("truncated.xml", std::string_view(truncated), options)
+                , basic_xml::unexpected_eof
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: truncated.xml:1:10: reached the end of the file while reading an attribute value."));
+
+        std::stringstream ss(truncated);
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  basic_xml::xml("truncated.xml", ss, options)
+                , basic_xml::unexpected_eof
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: truncated.xml:1:10: reached the end of the file while reading an attribute value."));
+
+        basic_xml::push_parser p("truncated.xml", options);
+        p.feed(truncated.data(), truncated.length());
+        CATCH_REQUIRE_THROWS_MATCHES(
+                  p.finish()
+                , basic_xml::unexpected_eof
+                , Catch::Matchers::ExceptionMessage(
+                          "xml_error: truncated.xml:1:10: reached the end of the file while reading an attribute value."));
     }
     CATCH_END_SECTION()
 }
@@ -19,6 +19,8 @@
 // self
 //
 #include    <basic-xml/exception.h>
+#include    <basic-xml/snapshot.h>
+#include    <basic-xml/validate.h>
 #include    <basic-xml/xml.h>
 
 
@@ -29,6 +31,7 @@
 
 // C++
 //
+#include    <fstream>
 #include    <iostream>
 
 
@@ -51,6 +54,7 @@ int main(int argc, char * argv[])
 {
     std::string filename;
     std::string path;
+    std::string snapshot_filename;
     bool lint(false);
     bool verbose(false);
     for(int i(1); i < argc; ++i)
@@ -60,13 +64,23 @@ int main(int argc, char * argv[])
             if(strcmp(argv[i], "-h") == 0
             || strcmp(argv[i], "--help") == 0)
             {
-                std::cout << "Usage: basic-xml [--lint | --verbose | --help | -h] [<filename>] [xpath]\n";
+                std::cout << "Usage: basic-xml [--lint | --compile <snapshot> | --verbose | --help | -h] [<filename>] [xpath]\n";
                 return 1;
             }
             else if(strcmp(argv[i], "--lint") == 0)
             {
                 lint = true;
             }
+            else if(strcmp(argv[i], "--compile") == 0)
+            {
+                ++i;
+                if(i >= argc)
+                {
+                    std::cerr << "basic-xml:error: --compile expects the name of the snapshot file.\n";
+                    return 1;
+                }
+                snapshot_filename = argv[i];
+            }
             else if(strcmp(argv[i], "--verbose") == 0)
             {
                 verbose = true;
@@ -99,6 +113,29 @@ int main(int argc, char * argv[])
         std::cerr << "basic-xml:warning: path ignored when --lint is used.\n";
     }
 
+    if(lint)
+    {
+        // no need for a tree of nodes to verify the XML
+        //
+        try
+        {
+            if(filename.empty())
+            {
+                basic_xml::validate("stdin", std::cin);
+            }
+            else
+            {
+                basic_xml::validate(filename);
+            }
+        }
+        catch(basic_xml::xml_error const & e)
+        {
+            std::cerr << "basic-xml:error: an error occurred: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
     basic_xml::xml * xml(nullptr);
     try
     {
@@ -117,6 +154,31 @@ int main(int argc, char * argv[])
         return 1;
     }
 
+    if(!snapshot_filename.empty())
+    {
+        if(!path.empty())
+        {
+            std::cerr << "basic-xml:warning: path ignored when --compile is used.\n";
+        }
+
+        try
+        {
+            std::ofstream out(snapshot_filename, std::ios::binary);
+            if(!out.is_open())
+            {
+                std::cerr << "basic-xml:error: could not create snapshot file \"" << snapshot_filename << "\".\n";
+                return 1;
+            }
+            basic_xml::write_snapshot(out, *xml->root());
+        }
+        catch(basic_xml::xml_error const & e)
+        {
+            std::cerr << "basic-xml:error: an error occurred: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
     if(!lint)
     {
         if(!path.empty())